@@ -39,6 +39,17 @@
 
 #define ANIMATION_SEQUENCE_FORCED 0x01
 
+// The maximum number of nodes in open and closed lists of [make_path_func].
+// The search cost does not depend on this value, it only limits how far the
+// search can go before giving up.
+#define PATH_NODE_LIST_CAPACITY 2000
+
+// The number of recently built paths remembered by [make_path_func].
+#define PATH_CACHE_CAPACITY 16
+
+// The maximum length of path built by [make_path_func].
+#define PATH_MAX_LENGTH 800
+
 typedef enum AnimationKind {
     ANIM_KIND_MOVE_TO_OBJECT = 0,
     ANIM_KIND_MOVE_TO_TILE = 1,
@@ -250,6 +261,22 @@ typedef struct AnimationSad {
 
 static_assert(sizeof(AnimationSad) == 3240, "wrong size");
 
+typedef struct PathCacheEntry {
+    Object* object;
+    int from;
+    int to;
+    int elevation;
+    bool a5;
+    bool inCombat;
+
+    // The value of [obj_get_blocker_generation] at the moment path was
+    // built.
+    unsigned int generation;
+
+    int length;
+    unsigned char rotations[PATH_MAX_LENGTH];
+} PathCacheEntry;
+
 static int anim_free_slot(int a1);
 static int anim_preload(Object* object, int fid, CacheEntry** cacheEntryPtr);
 static void anim_cleanup();
@@ -268,6 +295,12 @@ static int anim_animate(Object* obj, int anim, int animationSequenceIndex, int f
 static void object_anim_compact();
 static int anim_turn_towards(Object* obj, int delta, int animationSequenceIndex);
 static int check_gravity(int tile, int elevation);
+static int make_path_internal(Object* object, int from, int to, unsigned char* rotations, int a5, PathBuilderCallback* callback);
+static bool path_node_less(int slot1, int slot2);
+static void path_open_push(int slot);
+static int path_open_pop();
+static int path_slot_acquire();
+static void path_slot_release(int slot);
 
 // 0x510718
 static int curr_sad = 0;
@@ -287,8 +320,10 @@ static bool anim_in_bk = false;
 // 0x530014
 static AnimationSad sad[ANIMATION_SAD_LIST_CAPACITY];
 
+// Closed list of [make_path_func].
+//
 // 0x542FD4
-static PathNode dad[2000];
+static PathNode dad[PATH_NODE_LIST_CAPACITY];
 
 // 0x54CC14
 static AnimationSequence anim_set[ANIMATION_SEQUENCE_LIST_CAPACITY];
@@ -296,8 +331,45 @@ static AnimationSequence anim_set[ANIMATION_SEQUENCE_LIST_CAPACITY];
 // 0x561814
 static unsigned char seen[5000];
 
+// Open list of [make_path_func]. Slots are reused lowest index first, the
+// slot index is used to break ties between nodes of equal cost.
+//
 // 0x562B9C
-static PathNode child[2000];
+static PathNode child[PATH_NODE_LIST_CAPACITY];
+
+// Binary min-heap of occupied [child] slots ordered by node cost.
+static int path_open_heap[PATH_NODE_LIST_CAPACITY];
+
+// The number of slots in [path_open_heap].
+static int path_open_heap_length;
+
+// Binary min-heap of released [child] slots below [path_slots_used].
+static int path_free_slots[PATH_NODE_LIST_CAPACITY];
+
+// The number of slots in [path_free_slots].
+static int path_free_slots_length;
+
+// The number of [child] slots which were ever occupied during current path
+// search.
+static int path_slots_used;
+
+// Maps tile to the index of it's node in [dad]. Only valid for tiles in
+// closed list of current path search.
+static int path_closed_index[HEX_GRID_SIZE];
+
+// Recently built paths, replaced in round-robin fashion.
+static PathCacheEntry path_cache[PATH_CACHE_CAPACITY];
+
+// Index of the [path_cache] entry to be replaced next.
+static int path_cache_next = 0;
+
+// The number of [make_path_func] requests served from [path_cache] since the
+// last [make_path_dump_cache_stats].
+static unsigned long long path_cache_hits = 0;
+
+// The number of [make_path_func] requests which required a path search since
+// the last [make_path_dump_cache_stats].
+static unsigned long long path_cache_misses = 0;
 
 // 0x56C7DC
 static int curr_anim_counter;
@@ -326,6 +398,9 @@ void anim_reset()
         anim_set[index].field_0 = -1000;
         anim_set[index].flags = 0;
     }
+
+    memset(path_cache, 0, sizeof(path_cache));
+    path_cache_next = 0;
 }
 
 // 0x413AB8
@@ -333,6 +408,8 @@ void anim_exit()
 {
     // NOTE: Uninline.
     anim_stop();
+
+    make_path_dump_cache_stats();
 }
 
 // 0x413AF4
@@ -1801,6 +1878,70 @@ int make_path(Object* object, int from, int to, unsigned char* rotations, int a5
 
 // 0x415EFC
 int make_path_func(Object* object, int from, int to, unsigned char* rotations, int a5, PathBuilderCallback* callback)
+{
+    // Other callbacks either depend on object flags which are not tracked by
+    // blocker generation, or have side effects (`obj_ai_blocking_at`).
+    if (callback != obj_blocking_at) {
+        return make_path_internal(object, from, to, rotations, a5, callback);
+    }
+
+    bool inCombat = isInCombat();
+    unsigned int generation = obj_get_blocker_generation(object->elevation);
+
+    for (int index = 0; index < PATH_CACHE_CAPACITY; index++) {
+        PathCacheEntry* entry = &(path_cache[index]);
+        if (entry->object == object
+            && entry->from == from
+            && entry->to == to
+            && entry->elevation == object->elevation
+            && entry->a5 == (a5 != 0)
+            && entry->inCombat == inCombat
+            && entry->generation == generation) {
+            path_cache_hits++;
+
+            if (rotations != NULL) {
+                memcpy(rotations, entry->rotations, entry->length);
+            }
+
+            return entry->length;
+        }
+    }
+
+    path_cache_misses++;
+
+    PathCacheEntry* entry = &(path_cache[path_cache_next]);
+    path_cache_next = (path_cache_next + 1) % PATH_CACHE_CAPACITY;
+
+    entry->object = object;
+    entry->from = from;
+    entry->to = to;
+    entry->elevation = object->elevation;
+    entry->a5 = a5 != 0;
+    entry->inCombat = inCombat;
+    entry->generation = generation;
+    entry->length = make_path_internal(object, from, to, entry->rotations, a5, callback);
+
+    if (rotations != NULL) {
+        memcpy(rotations, entry->rotations, entry->length);
+    }
+
+    return entry->length;
+}
+
+// Prints the number of [make_path_func] requests served from cache and the
+// number of requests which required path search to debug log, and resets
+// both counters.
+void make_path_dump_cache_stats()
+{
+    debug_printf("\npath cache: %llu hits, %llu misses\n",
+        path_cache_hits,
+        path_cache_misses);
+
+    path_cache_hits = 0;
+    path_cache_misses = 0;
+}
+
+static int make_path_internal(Object* object, int from, int to, unsigned char* rotations, int a5, PathBuilderCallback* callback)
 {
     if (a5) {
         if (callback(object, to, object->elevation) != NULL) {
@@ -1821,61 +1962,46 @@ int make_path_func(Object* object, int from, int to, unsigned char* rotations, i
 
     seen[from / 8] |= 1 << (from & 7);
 
-    child[0].tile = from;
-    child[0].from = -1;
-    child[0].rotation = 0;
-    child[0].field_C = EST(from, to);
-    child[0].field_10 = 0;
+    path_open_heap_length = 0;
+    path_free_slots_length = 0;
+    path_slots_used = 0;
 
-    for (int index = 1; index < 2000; index += 1) {
-        child[index].tile = -1;
-    }
+    int slot = path_slot_acquire();
+    child[slot].tile = from;
+    child[slot].from = -1;
+    child[slot].rotation = 0;
+    child[slot].field_C = EST(from, to);
+    child[slot].field_10 = 0;
+    path_open_push(slot);
 
     int toScreenX;
     int toScreenY;
     tile_coord(to, &toScreenX, &toScreenY, object->elevation);
 
     int closedPathNodeListLength = 0;
-    int openPathNodeListLength = 1;
     PathNode temp;
+    bool found = false;
 
-    while (1) {
-        int v63 = -1;
-
-        PathNode* prev = NULL;
-        int v12 = 0;
-        for (int index = 0; v12 < openPathNodeListLength; index += 1) {
-            PathNode* curr = &(child[index]);
-            if (curr->tile != -1) {
-                v12++;
-                if (v63 == -1 || (curr->field_C + curr->field_10) < (prev->field_C + prev->field_10)) {
-                    prev = curr;
-                    v63 = index;
-                }
-            }
-        }
-
-        PathNode* curr = &(child[v63]);
-
-        memcpy(&temp, curr, sizeof(temp));
-
-        openPathNodeListLength -= 1;
-
-        curr->tile = -1;
+    while (path_open_heap_length != 0) {
+        // Take the cheapest node from the open list. Its slot is released
+        // immediately, so that the first expanded neighbour can reuse it.
+        slot = path_open_pop();
+        memcpy(&temp, &(child[slot]), sizeof(temp));
+        path_slot_release(slot);
 
         if (temp.tile == to) {
-            if (openPathNodeListLength == 0) {
-                openPathNodeListLength = 1;
-            }
+            found = true;
             break;
         }
 
+        path_closed_index[temp.tile] = closedPathNodeListLength;
+
         PathNode* curr1 = &(dad[closedPathNodeListLength]);
         memcpy(curr1, &temp, sizeof(temp));
 
         closedPathNodeListLength += 1;
 
-        if (closedPathNodeListLength == 2000) {
+        if (closedPathNodeListLength == PATH_NODE_LIST_CAPACITY) {
             return 0;
         }
 
@@ -1895,22 +2021,15 @@ int make_path_func(Object* object, int from, int to, unsigned char* rotations, i
                 }
             }
 
-            int v25 = 0;
-            for (; v25 < 2000; v25++) {
-                if (child[v25].tile == -1) {
-                    break;
-                }
-            }
-
-            openPathNodeListLength += 1;
-
-            if (openPathNodeListLength == 2000) {
+            if (path_open_heap_length + 1 == PATH_NODE_LIST_CAPACITY) {
                 return 0;
             }
 
             seen[tile / 8] |= bit;
 
-            PathNode* v27 = &(child[v25]);
+            slot = path_slot_acquire();
+
+            PathNode* v27 = &(child[slot]);
             v27->tile = tile;
             v27->from = temp.tile;
             v27->rotation = rotation;
@@ -1943,17 +2062,15 @@ int make_path_func(Object* object, int from, int to, unsigned char* rotations, i
                     }
                 }
             }
-        }
 
-        if (openPathNodeListLength == 0) {
-            break;
+            path_open_push(slot);
         }
     }
 
-    if (openPathNodeListLength != 0) {
+    if (found) {
         unsigned char* v39 = rotations;
         int index = 0;
-        for (; index < 800; index++) {
+        for (; index < PATH_MAX_LENGTH; index++) {
             if (temp.tile == from) {
                 break;
             }
@@ -1963,12 +2080,7 @@ int make_path_func(Object* object, int from, int to, unsigned char* rotations, i
                 v39 += 1;
             }
 
-            int j = 0;
-            while (dad[j].tile != temp.from) {
-                j++;
-            }
-
-            PathNode* v36 = &(dad[j]);
+            PathNode* v36 = &(dad[path_closed_index[temp.from]]);
             memcpy(&temp, v36, sizeof(temp));
         }
 
@@ -1994,6 +2106,110 @@ int make_path_func(Object* object, int from, int to, unsigned char* rotations, i
     return 0;
 }
 
+// Returns `true` if node in [child] slot `slot1` should be expanded before
+// node in slot `slot2`. Nodes of equal cost are ordered by slot index, which
+// matches the order of the original linear scan.
+static bool path_node_less(int slot1, int slot2)
+{
+    int cost1 = child[slot1].field_C + child[slot1].field_10;
+    int cost2 = child[slot2].field_C + child[slot2].field_10;
+    if (cost1 != cost2) {
+        return cost1 < cost2;
+    }
+    return slot1 < slot2;
+}
+
+static void path_open_push(int slot)
+{
+    int index = path_open_heap_length++;
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!path_node_less(slot, path_open_heap[parent])) {
+            break;
+        }
+
+        path_open_heap[index] = path_open_heap[parent];
+        index = parent;
+    }
+    path_open_heap[index] = slot;
+}
+
+static int path_open_pop()
+{
+    int top = path_open_heap[0];
+    int slot = path_open_heap[--path_open_heap_length];
+
+    int index = 0;
+    while (1) {
+        int next = index * 2 + 1;
+        if (next >= path_open_heap_length) {
+            break;
+        }
+
+        if (next + 1 < path_open_heap_length && path_node_less(path_open_heap[next + 1], path_open_heap[next])) {
+            next += 1;
+        }
+
+        if (!path_node_less(path_open_heap[next], slot)) {
+            break;
+        }
+
+        path_open_heap[index] = path_open_heap[next];
+        index = next;
+    }
+    path_open_heap[index] = slot;
+
+    return top;
+}
+
+// Returns the lowest unoccupied [child] slot.
+static int path_slot_acquire()
+{
+    if (path_free_slots_length == 0) {
+        return path_slots_used++;
+    }
+
+    int top = path_free_slots[0];
+    int slot = path_free_slots[--path_free_slots_length];
+
+    int index = 0;
+    while (1) {
+        int next = index * 2 + 1;
+        if (next >= path_free_slots_length) {
+            break;
+        }
+
+        if (next + 1 < path_free_slots_length && path_free_slots[next + 1] < path_free_slots[next]) {
+            next += 1;
+        }
+
+        if (path_free_slots[next] >= slot) {
+            break;
+        }
+
+        path_free_slots[index] = path_free_slots[next];
+        index = next;
+    }
+    path_free_slots[index] = slot;
+
+    return top;
+}
+
+static void path_slot_release(int slot)
+{
+    int index = path_free_slots_length++;
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (path_free_slots[parent] <= slot) {
+            break;
+        }
+
+        path_free_slots[index] = path_free_slots[parent];
+        index = parent;
+    }
+    path_free_slots[index] = slot;
+}
+
 // 0x41633C
 int idist(int x1, int y1, int x2, int y2)
 {
@@ -2226,11 +2442,13 @@ static int anim_move_to_object(Object* from, Object* to, int a3, int anim, int a
 {
     bool hidden = (to->flags & OBJECT_HIDDEN);
     to->flags |= OBJECT_HIDDEN;
+    obj_invalidate_blockers(to->elevation);
 
     int moveSadIndex = anim_move(from, to->tile, to->elevation, -1, anim, 0, animationSequenceIndex);
 
     if (!hidden) {
         to->flags &= ~OBJECT_HIDDEN;
+        obj_invalidate_blockers(to->elevation);
     }
 
     if (moveSadIndex == -1) {
@@ -2833,6 +3051,10 @@ void object_animate()
 
     anim_in_bk = 1;
 
+    // Animated objects often overlap (e.g. crowds of critters), render their
+    // dirty rects once for all of them.
+    tile_refresh_batch_begin();
+
     for (int index = 0; index < curr_sad; index++) {
         AnimationSad* sad_entry = &(sad[index]);
         if (sad_entry->field_20 == -1000) {
@@ -2988,6 +3210,8 @@ void object_animate()
         }
     }
 
+    tile_refresh_batch_end();
+
     anim_in_bk = 0;
 
     object_anim_compact();
@@ -1,5 +1,6 @@
 #include "game/art.h"
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,6 +18,62 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
+// The maximum number of background threads used by [art_preload].
+#define ART_PRELOAD_THREADS_MAX 4
+
+// The maximum number of files staged by [art_preload] at once.
+#define ART_PRELOAD_BATCH_LENGTH 64
+
+// The maximum total size of files staged by [art_preload] at once.
+#define ART_PRELOAD_BATCH_SIZE (4 * 1024 * 1024)
+
+typedef struct ArtPreloadJob {
+    int fid;
+
+    // The stream opened on the main thread, or NULL if this art is already
+    // cached or cannot be found.
+    File* stream;
+    int fileSize;
+
+    // Decoded art (see [load_frame_from_buffer]) allocated with [malloc], or
+    // NULL if decoding failed.
+    unsigned char* data;
+    int size;
+} ArtPreloadJob;
+
+typedef struct ArtPreloadBatch {
+    ArtPreloadJob jobs[ART_PRELOAD_BATCH_LENGTH];
+    int jobsLength;
+
+    // The number of jobs taken by workers so far.
+    volatile LONG jobsTaken;
+} ArtPreloadBatch;
+
+// The initial number of slots in [art_resolved_names], must be a power of
+// two.
+#define ART_RESOLVED_NAMES_INITIAL_LENGTH 1024
+
+// Describes which file backs particular fid, see [art_resolve_name].
+typedef struct ArtResolvedName {
+    // The fid, or -1 if this slot is empty.
+    int fid;
+
+    // The path of file to load, with localized override already applied.
+    char* path;
+
+    // The size of cache entry needed to load this file (see
+    // [art_data_size]).
+    int size;
+} ArtResolvedName;
+
+static ArtResolvedName* art_resolve_name(int fid);
+static unsigned int art_resolved_name_hash(int fid);
+static bool art_resolved_names_grow();
+static void art_resolved_names_free();
+static void art_preload_decode(ArtPreloadJob* job);
+static DWORD WINAPI art_preload_worker(LPVOID param);
+static File* art_preload_open(int fid, int* fileSizePtr);
+
 // 0x510738
 static ArtListDescription art[OBJ_TYPE_COUNT] = {
     { 0, "items", 0, 0, 0 },
@@ -90,6 +147,20 @@ static int* anon_alias;
 // 0x56CAF0
 static int* artCritterFidShouldRunData;
 
+// Open-addressing hash table of files resolved so far keyed by fid, so cache
+// misses don't format and search paths again.
+static ArtResolvedName* art_resolved_names;
+
+// The number of slots in [art_resolved_names], always a power of two.
+static int art_resolved_names_length;
+
+// The number of occupied slots in [art_resolved_names].
+static int art_resolved_names_count;
+
+// The job which is being handed to [art_cache] by [art_preload], consumed by
+// [art_data_size] and [art_data_load] instead of reading the file.
+static ArtPreloadJob* art_preload_current;
+
 // 0x418840
 int art_init()
 {
@@ -288,6 +359,8 @@ void art_exit()
 {
     cache_exit(&art_cache);
 
+    art_resolved_names_free();
+
     mem_free(anon_alias);
     mem_free(artCritterFidShouldRunData);
 
@@ -487,6 +560,212 @@ int art_flush()
     return cache_flush(&art_cache);
 }
 
+// Loads every art in [fids] into cache, in order.
+//
+// Files missing from cache are read and decoded on background threads in
+// batches, while database lookups and cache insertions remain on the main
+// thread.
+void art_preload(int* fids, int fidsLength)
+{
+    ArtPreloadBatch* batch = (ArtPreloadBatch*)mem_malloc(sizeof(*batch));
+    if (batch == NULL) {
+        // Load everything synchronously.
+        for (int index = 0; index < fidsLength; index++) {
+            CacheEntry* handle;
+            if (art_ptr_lock(fids[index], &handle) != NULL) {
+                art_ptr_unlock(handle);
+            }
+        }
+        return;
+    }
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+
+    // The main thread takes jobs as well.
+    int threadsLength = (int)systemInfo.dwNumberOfProcessors - 1;
+    if (threadsLength > ART_PRELOAD_THREADS_MAX) {
+        threadsLength = ART_PRELOAD_THREADS_MAX;
+    }
+
+    int start = 0;
+    while (start < fidsLength) {
+        int stagedSize = 0;
+        int stagedLength = 0;
+
+        batch->jobsLength = 0;
+        batch->jobsTaken = 0;
+
+        while (start + batch->jobsLength < fidsLength
+            && batch->jobsLength < ART_PRELOAD_BATCH_LENGTH
+            && stagedSize < ART_PRELOAD_BATCH_SIZE) {
+            ArtPreloadJob* job = &(batch->jobs[batch->jobsLength++]);
+            job->fid = fids[start + batch->jobsLength - 1];
+            job->stream = NULL;
+            job->fileSize = 0;
+            job->data = NULL;
+            job->size = 0;
+
+            if (!cache_query(&art_cache, job->fid)) {
+                job->stream = art_preload_open(job->fid, &(job->fileSize));
+                if (job->stream != NULL) {
+                    stagedSize += job->fileSize;
+                    stagedLength++;
+                }
+            }
+        }
+
+        HANDLE threads[ART_PRELOAD_THREADS_MAX];
+        int threadsStarted = 0;
+        for (int index = 0; index < threadsLength && index < stagedLength - 1; index++) {
+            threads[threadsStarted] = CreateThread(NULL, 0, art_preload_worker, batch, 0, NULL);
+            if (threads[threadsStarted] == NULL) {
+                break;
+            }
+            threadsStarted++;
+        }
+
+        art_preload_worker(batch);
+
+        if (threadsStarted != 0) {
+            WaitForMultipleObjects(threadsStarted, threads, TRUE, INFINITE);
+            for (int index = 0; index < threadsStarted; index++) {
+                CloseHandle(threads[index]);
+            }
+        }
+
+        for (int index = 0; index < batch->jobsLength; index++) {
+            ArtPreloadJob* job = &(batch->jobs[index]);
+
+            // Arts which failed to decode in background are loaded the usual
+            // way.
+            if (job->data != NULL) {
+                art_preload_current = job;
+            }
+
+            CacheEntry* handle;
+            if (art_ptr_lock(job->fid, &handle) != NULL) {
+                art_ptr_unlock(handle);
+            }
+
+            art_preload_current = NULL;
+
+            if (job->data != NULL) {
+                free(job->data);
+            }
+
+            if (job->stream != NULL) {
+                db_fclose(job->stream);
+            }
+        }
+
+        start += batch->jobsLength;
+    }
+
+    mem_free(batch);
+}
+
+// Reads and decodes the file of [job].
+//
+// NOTE: This function runs on background threads. It uses [xfread] instead of
+// [db_fread] to bypass read progress callback, and [malloc] instead of
+// [mem_malloc] which is not thread-safe.
+static void art_preload_decode(ArtPreloadJob* job)
+{
+    unsigned char header[sizeof(Art)];
+    if (job->fileSize < (int)sizeof(header)) {
+        return;
+    }
+
+    if (xfread(header, 1, sizeof(header), job->stream) != sizeof(header)) {
+        return;
+    }
+
+    // Only frame count is needed to size the buffer, it's stored in
+    // big-endian.
+    unsigned char* frameCountBytes = header + offsetof(Art, frameCount);
+    Art artHeader;
+    artHeader.frameCount = (short)((frameCountBytes[0] << 8) | frameCountBytes[1]);
+    if (artHeader.frameCount < 0) {
+        return;
+    }
+
+    int size = job->fileSize + art_frame_offsets_size(&artHeader);
+    unsigned char* data = (unsigned char*)malloc(size);
+    if (data == NULL) {
+        return;
+    }
+
+    memcpy(data, header, sizeof(header));
+
+    int remainingSize = job->fileSize - sizeof(header);
+    if (remainingSize != 0) {
+        if ((int)xfread(data + sizeof(header), 1, remainingSize, job->stream) != remainingSize) {
+            free(data);
+            return;
+        }
+    }
+
+    if (load_frame_from_buffer(data, job->fileSize) != 0) {
+        free(data);
+        return;
+    }
+
+    job->data = data;
+    job->size = size;
+}
+
+// Takes jobs from [ArtPreloadBatch] passed in [param] until there are none
+// left.
+static DWORD WINAPI art_preload_worker(LPVOID param)
+{
+    ArtPreloadBatch* batch = (ArtPreloadBatch*)param;
+
+    while (true) {
+        int index = InterlockedIncrement(&(batch->jobsTaken)) - 1;
+        if (index >= batch->jobsLength) {
+            break;
+        }
+
+        ArtPreloadJob* job = &(batch->jobs[index]);
+        if (job->stream != NULL) {
+            art_preload_decode(job);
+        }
+    }
+
+    return 0;
+}
+
+// Opens the file of [fid] the same way as [art_data_load] does.
+static File* art_preload_open(int fid, int* fileSizePtr)
+{
+    ArtResolvedName* resolvedName = art_resolve_name(fid);
+    if (resolvedName == NULL) {
+        return NULL;
+    }
+
+    int oldDb = -1;
+    if (FID_TYPE(fid) == OBJ_TYPE_CRITTER) {
+        oldDb = db_current();
+        db_select(critter_db_handle);
+    }
+
+    File* stream = db_fopen(resolvedName->path, "rb");
+    if (stream != NULL) {
+        *fileSizePtr = db_filelength(stream);
+
+        // Jobs in the same batch can read the same entry at once (different
+        // fids can resolve to the same file).
+        xfdetach_seek_index(stream);
+    }
+
+    if (oldDb != -1) {
+        db_select(oldDb);
+    }
+
+    return stream;
+}
+
 // NOTE: Unused.
 //
 // 0x419294
@@ -822,11 +1101,8 @@ ArtFrame* frame_ptr(Art* art, int frame, int rotation)
         return NULL;
     }
 
-    ArtFrame* frm = (ArtFrame*)((unsigned char*)art + sizeof(*art) + art->dataOffsets[rotation]);
-    for (int index = 0; index < frame; index++) {
-        frm = (ArtFrame*)((unsigned char*)frm + sizeof(*frm) + frm->size);
-    }
-    return frm;
+    int offset = ART_FRAME_OFFSETS(art)[rotation * art->frameCount + frame];
+    return (ArtFrame*)((unsigned char*)art + sizeof(*art) + offset);
 }
 
 // 0x4198C8
@@ -925,99 +1201,207 @@ int art_alias_fid(int fid)
 
 // 0x419A78
 int art_data_size(int fid, int* sizePtr)
+{
+    if (art_preload_current != NULL && art_preload_current->fid == fid) {
+        *sizePtr = art_preload_current->size;
+        return 0;
+    }
+
+    ArtResolvedName* resolvedName = art_resolve_name(fid);
+    if (resolvedName == NULL) {
+        return -1;
+    }
+
+    *sizePtr = resolvedName->size;
+
+    return 0;
+}
+
+// 0x419B78
+int art_data_load(int fid, int* sizePtr, unsigned char* data)
 {
     int oldDb = -1;
     int result = -1;
 
+    if (art_preload_current != NULL && art_preload_current->fid == fid) {
+        memcpy(data, art_preload_current->data, art_preload_current->size);
+        *sizePtr = ((Art*)data)->field_3A + 74 + art_frame_offsets_size((Art*)data);
+        return 0;
+    }
+
+    // NOTE: Original code tries localized file first, and falls back to
+    // non-localized one if it fails to load. The file is now chosen once by
+    // [art_resolve_name], and the entry was sized for it by
+    // [art_data_size], so there is no fallback.
+    ArtResolvedName* resolvedName = art_resolve_name(fid);
+    if (resolvedName == NULL) {
+        return -1;
+    }
+
     if (FID_TYPE(fid) == OBJ_TYPE_CRITTER) {
         oldDb = db_current();
         db_select(critter_db_handle);
     }
 
+    if (load_frame_into(resolvedName->path, data) == 0) {
+        // TODO: Why it adds 74?
+        *sizePtr = ((Art*)data)->field_3A + 74 + art_frame_offsets_size((Art*)data);
+        result = 0;
+    }
+
+    if (oldDb != -1) {
+        db_select(oldDb);
+    }
+
+    return result;
+}
+
+// Returns the file which backs [fid], or NULL if there is no such file.
+//
+// The localized file is preferred when it's present. Results are remembered
+// in [art_resolved_names], so only the first call for every fid formats paths
+// and probes database.
+static ArtResolvedName* art_resolve_name(int fid)
+{
+    if (art_resolved_names != NULL) {
+        int mask = art_resolved_names_length - 1;
+        int index = art_resolved_name_hash(fid) & mask;
+        while (art_resolved_names[index].fid != -1) {
+            if (art_resolved_names[index].fid == fid) {
+                return &(art_resolved_names[index]);
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    int oldDb = -1;
+    if (FID_TYPE(fid) == OBJ_TYPE_CRITTER) {
+        oldDb = db_current();
+        db_select(critter_db_handle);
+    }
+
+    char path[MAX_PATH];
+    Art header;
+    int fileSize;
+    bool loaded = false;
+
     char* artFilePath = art_get_name(fid);
     if (artFilePath != NULL) {
-        int fileSize;
-        bool loaded = false;
-
+        // The header is needed to reserve room for frame offsets table which
+        // is built by [load_frame_into].
         if (darn_foreigners) {
             char* pch = strchr(artFilePath, '\\');
             if (pch == NULL) {
                 pch = artFilePath;
             }
 
-            char localizedPath[MAX_PATH];
-            sprintf(localizedPath, "art\\%s\\%s", darn_foreign_sub_path, pch);
+            sprintf(path, "art\\%s\\%s", darn_foreign_sub_path, pch);
 
-            if (db_dir_entry(localizedPath, &fileSize) == 0) {
+            if (load_frame_header(path, &header, &fileSize) == 0) {
                 loaded = true;
             }
         }
 
         if (!loaded) {
-            if (db_dir_entry(artFilePath, &fileSize) == 0) {
+            strcpy(path, artFilePath);
+
+            if (load_frame_header(path, &header, &fileSize) == 0) {
                 loaded = true;
             }
         }
-
-        if (loaded) {
-            *sizePtr = fileSize;
-            result = 0;
-        }
     }
 
     if (oldDb != -1) {
         db_select(oldDb);
     }
 
-    return result;
+    if (!loaded) {
+        return NULL;
+    }
+
+    if (art_resolved_names_count * 2 >= art_resolved_names_length) {
+        if (!art_resolved_names_grow()) {
+            return NULL;
+        }
+    }
+
+    char* pathCopy = mem_strdup(path);
+    if (pathCopy == NULL) {
+        return NULL;
+    }
+
+    int mask = art_resolved_names_length - 1;
+    int index = art_resolved_name_hash(fid) & mask;
+    while (art_resolved_names[index].fid != -1) {
+        index = (index + 1) & mask;
+    }
+
+    ArtResolvedName* resolvedName = &(art_resolved_names[index]);
+    resolvedName->fid = fid;
+    resolvedName->path = pathCopy;
+    resolvedName->size = fileSize + art_frame_offsets_size(&header);
+    art_resolved_names_count++;
+
+    return resolvedName;
 }
 
-// 0x419B78
-int art_data_load(int fid, int* sizePtr, unsigned char* data)
+static unsigned int art_resolved_name_hash(int fid)
 {
-    int oldDb = -1;
-    int result = -1;
+    unsigned int hash = (unsigned int)fid * 2654435761U;
+    return hash ^ (hash >> 16);
+}
 
-    if (FID_TYPE(fid) == OBJ_TYPE_CRITTER) {
-        oldDb = db_current();
-        db_select(critter_db_handle);
+// Doubles the number of slots in [art_resolved_names].
+static bool art_resolved_names_grow()
+{
+    int length = art_resolved_names_length != 0 ? art_resolved_names_length * 2 : ART_RESOLVED_NAMES_INITIAL_LENGTH;
+    ArtResolvedName* resolvedNames = (ArtResolvedName*)mem_malloc(sizeof(*resolvedNames) * length);
+    if (resolvedNames == NULL) {
+        return false;
     }
 
-    char* artFileName = art_get_name(fid);
-    if (artFileName != NULL) {
-        bool loaded = false;
-        if (darn_foreigners) {
-            char* pch = strchr(artFileName, '\\');
-            if (pch == NULL) {
-                pch = artFileName;
-            }
-
-            char localizedPath[MAX_PATH];
-            sprintf(localizedPath, "art\\%s\\%s", darn_foreign_sub_path, pch);
+    for (int index = 0; index < length; index++) {
+        resolvedNames[index].fid = -1;
+    }
 
-            if (load_frame_into(localizedPath, data) == 0) {
-                loaded = true;
+    int mask = length - 1;
+    for (int oldIndex = 0; oldIndex < art_resolved_names_length; oldIndex++) {
+        ArtResolvedName* resolvedName = &(art_resolved_names[oldIndex]);
+        if (resolvedName->fid != -1) {
+            int index = art_resolved_name_hash(resolvedName->fid) & mask;
+            while (resolvedNames[index].fid != -1) {
+                index = (index + 1) & mask;
             }
+            resolvedNames[index] = *resolvedName;
         }
+    }
 
-        if (!loaded) {
-            if (load_frame_into(artFileName, data) == 0) {
-                loaded = true;
-            }
-        }
+    if (art_resolved_names != NULL) {
+        mem_free(art_resolved_names);
+    }
 
-        if (loaded) {
-            // TODO: Why it adds 74?
-            *sizePtr = ((Art*)data)->field_3A + 74;
-            result = 0;
-        }
+    art_resolved_names = resolvedNames;
+    art_resolved_names_length = length;
+
+    return true;
+}
+
+static void art_resolved_names_free()
+{
+    if (art_resolved_names == NULL) {
+        return;
     }
 
-    if (oldDb != -1) {
-        db_select(oldDb);
+    for (int index = 0; index < art_resolved_names_length; index++) {
+        if (art_resolved_names[index].fid != -1) {
+            mem_free(art_resolved_names[index].path);
+        }
     }
 
-    return result;
+    mem_free(art_resolved_names);
+    art_resolved_names = NULL;
+    art_resolved_names_length = 0;
+    art_resolved_names_count = 0;
 }
 
 // 0x419C80
@@ -72,12 +72,20 @@ typedef struct Art {
     short xOffsets[6];
     short yOffsets[6];
     int dataOffsets[6];
+
+    // Size of frame data. Loaded art is followed by the frame offsets table
+    // at this offset (see [ART_FRAME_OFFSETS]).
     int field_3A;
 } Art;
 #pragma pack()
 
 static_assert(sizeof(Art) == 62, "wrong size");
 
+// Returns the table of frame offsets built when [art] is loaded. Offset of
+// frame `n` in rotation `r` is at index `r * frameCount + n` and is relative to
+// the end of [Art] header, the same as `dataOffsets`.
+#define ART_FRAME_OFFSETS(art) ((int*)((unsigned char*)(art) + sizeof(Art) + (art)->field_3A))
+
 typedef struct ArtFrame {
     short width;
     short height;
@@ -148,6 +156,7 @@ unsigned char* art_lock(int fid, CacheEntry** out_cache_entry, int* widthPtr, in
 int art_ptr_unlock(CacheEntry* cache_entry);
 int art_discard(int fid);
 int art_flush();
+void art_preload(int* fids, int fidsLength);
 int art_get_base_name(int objectType, int a2, char* a3);
 int art_get_code(int a1, int a2, char* a3, char* a4);
 char* art_get_name(int a1);
@@ -1,9 +1,15 @@
 #include "game/artload.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "plib/gnw/memory.h"
 
 static int art_readSubFrameData(unsigned char* data, File* stream, int count);
 static int art_readFrameData(Art* art, File* stream);
+static void art_buildFrameOffsets(Art* art);
+static void art_swapShort(short* value);
+static void art_swapInt(int* value);
 
 // 0x419D60
 static int art_readSubFrameData(unsigned char* data, File* stream, int count)
@@ -40,6 +46,153 @@ static int art_readFrameData(Art* art, File* stream)
     return 0;
 }
 
+// Fills frame offsets table of [art] which is placed right after frame data
+// (see [ART_FRAME_OFFSETS]).
+//
+// `field_3A` is normalized to the actual end of frame data first, so the
+// table never overlaps frames even if the header is inaccurate.
+static void art_buildFrameOffsets(Art* art)
+{
+    unsigned char* data = (unsigned char*)art + sizeof(Art);
+
+    int end = 0;
+    for (int rotation = 0; rotation < ROTATION_COUNT; rotation++) {
+        int offset = art->dataOffsets[rotation];
+        for (int frame = 0; frame < art->frameCount; frame++) {
+            offset += sizeof(ArtFrame) + ((ArtFrame*)(data + offset))->size;
+        }
+
+        if (offset > end) {
+            end = offset;
+        }
+    }
+
+    art->field_3A = end;
+
+    int* offsets = ART_FRAME_OFFSETS(art);
+    for (int rotation = 0; rotation < ROTATION_COUNT; rotation++) {
+        int offset = art->dataOffsets[rotation];
+        for (int frame = 0; frame < art->frameCount; frame++) {
+            offsets[rotation * art->frameCount + frame] = offset;
+            offset += sizeof(ArtFrame) + ((ArtFrame*)(data + offset))->size;
+        }
+    }
+}
+
+// Returns the number of bytes needed to hold frame offsets table of [art] in
+// addition to the file contents.
+int art_frame_offsets_size(Art* art)
+{
+    return ROTATION_COUNT * art->frameCount * sizeof(int);
+}
+
+// Reads only the header of the FRM at [path] into [art], and reports it's
+// file size.
+int load_frame_header(const char* path, Art* art, int* fileSizePtr)
+{
+    File* stream = db_fopen(path, "rb");
+    if (stream == NULL) {
+        return -2;
+    }
+
+    *fileSizePtr = db_filelength(stream);
+
+    if (art_readFrameData(art, stream) != 0) {
+        db_fclose(stream);
+        return -3;
+    }
+
+    db_fclose(stream);
+    return 0;
+}
+
+// Converts big-endian [value] read as is from FRM file to native byte order.
+static void art_swapShort(short* value)
+{
+#if defined(_MSC_VER)
+    *value = (short)_byteswap_ushort((unsigned short)*value);
+#else
+    *value = (short)__builtin_bswap16((unsigned short)*value);
+#endif
+}
+
+// Converts big-endian [value] read as is from FRM file to native byte order.
+static void art_swapInt(int* value)
+{
+#if defined(_MSC_VER)
+    *value = (int)_byteswap_ulong((unsigned long)*value);
+#else
+    *value = (int)__builtin_bswap32((unsigned int)*value);
+#endif
+}
+
+// Converts raw contents of FRM file of [size] bytes previously read into
+// [data] to the layout produced by [load_frame_into] in place. [data] must
+// have room for frame offsets table past [size] bytes.
+//
+// Unlike other loading functions this one does not touch database, so it can
+// be used from background threads.
+//
+// Returns non-zero if the file is malformed or it's rotations are not stored
+// back to back, such files should be loaded with [load_frame_into].
+int load_frame_from_buffer(unsigned char* data, int size)
+{
+    if (size < (int)sizeof(Art)) {
+        return -3;
+    }
+
+    Art* art = (Art*)data;
+    art_swapInt(&(art->field_0));
+    art_swapShort(&(art->framesPerSecond));
+    art_swapShort(&(art->actionFrame));
+    art_swapShort(&(art->frameCount));
+    for (int index = 0; index < ROTATION_COUNT; index++) {
+        art_swapShort(&(art->xOffsets[index]));
+        art_swapShort(&(art->yOffsets[index]));
+        art_swapInt(&(art->dataOffsets[index]));
+    }
+    art_swapInt(&(art->field_3A));
+
+    unsigned char* frameData = data + sizeof(Art);
+    int frameDataSize = size - sizeof(Art);
+
+    // [load_frame_into] reads unique rotations sequentially, so file contents
+    // can be used in place only when every such rotation starts exactly where
+    // the previous one ends.
+    int offset = 0;
+    for (int index = 0; index < ROTATION_COUNT; index++) {
+        if (index == 0 || art->dataOffsets[index - 1] != art->dataOffsets[index]) {
+            if (art->dataOffsets[index] != offset) {
+                return -5;
+            }
+
+            for (int frame = 0; frame < art->frameCount; frame++) {
+                if (frameDataSize - offset < (int)sizeof(ArtFrame)) {
+                    return -5;
+                }
+
+                ArtFrame* frm = (ArtFrame*)(frameData + offset);
+                art_swapShort(&(frm->width));
+                art_swapShort(&(frm->height));
+                art_swapInt(&(frm->size));
+                art_swapShort(&(frm->x));
+                art_swapShort(&(frm->y));
+
+                // Empty frames are rejected by [art_readSubFrameData] too.
+                if (frm->size <= 0 || frameDataSize - offset - (int)sizeof(ArtFrame) < frm->size) {
+                    return -5;
+                }
+
+                offset += sizeof(ArtFrame) + frm->size;
+            }
+        }
+    }
+
+    art_buildFrameOffsets(art);
+
+    return 0;
+}
+
 // NOTE: Unused.
 //
 // 0x419EC0
@@ -48,27 +201,30 @@ int load_frame(const char* path, Art** artPtr)
     int size;
     File* stream;
     int index;
+    Art header;
 
     if (db_dir_entry(path, &size) == -1) {
         return -2;
     }
 
-    *artPtr = (Art*)mem_malloc(size);
-    if (*artPtr == NULL) {
-        return -1;
-    }
-
     stream = db_fopen(path, "rb");
     if (stream == NULL) {
         return -2;
     }
 
-    if (art_readFrameData(*artPtr, stream) != 0) {
+    if (art_readFrameData(&header, stream) != 0) {
         db_fclose(stream);
-        mem_free(*artPtr);
         return -3;
     }
 
+    *artPtr = (Art*)mem_malloc(size + art_frame_offsets_size(&header));
+    if (*artPtr == NULL) {
+        db_fclose(stream);
+        return -1;
+    }
+
+    memcpy(*artPtr, &header, sizeof(header));
+
     for (index = 0; index < ROTATION_COUNT; index++) {
         if (index == 0 || (*artPtr)->dataOffsets[index - 1] != (*artPtr)->dataOffsets[index]) {
             if (art_readSubFrameData((unsigned char*)(*artPtr) + sizeof(Art) + (*artPtr)->dataOffsets[index], stream, (*artPtr)->frameCount) != 0) {
@@ -85,9 +241,14 @@ int load_frame(const char* path, Art** artPtr)
 
     db_fclose(stream);
 
+    art_buildFrameOffsets(*artPtr);
+
     return 0;
 }
 
+// Reads the FRM at [path] into [data], which must have room for the file
+// contents plus frame offsets table (see [art_frame_offsets_size]).
+//
 // 0x419FC0
 int load_frame_into(const char* path, unsigned char* data)
 {
@@ -96,6 +257,19 @@ int load_frame_into(const char* path, unsigned char* data)
         return -2;
     }
 
+    // Read entire file in one go and convert it in place, which avoids
+    // reading headers field by field. Files with rotations which are not
+    // stored back to back are read piece by piece below.
+    int fileSize = db_filelength(stream);
+    if (fileSize >= (int)sizeof(Art) && (int)db_fread(data, 1, fileSize, stream) == fileSize) {
+        if (load_frame_from_buffer(data, fileSize) == 0) {
+            db_fclose(stream);
+            return 0;
+        }
+    }
+
+    db_rewind(stream);
+
     Art* art = (Art*)data;
     if (art_readFrameData(art, stream) != 0) {
         db_fclose(stream);
@@ -112,6 +286,9 @@ int load_frame_into(const char* path, unsigned char* data)
     }
 
     db_fclose(stream);
+
+    art_buildFrameOffsets(art);
+
     return 0;
 }
 
@@ -4,8 +4,11 @@
 #include "game/art.h"
 #include "plib/db/db.h"
 
+int art_frame_offsets_size(Art* art);
+int load_frame_header(const char* path, Art* art, int* fileSizePtr);
 int load_frame(const char* path, Art** artPtr);
 int load_frame_into(const char* path, unsigned char* data);
+int load_frame_from_buffer(unsigned char* data, int size);
 int art_writeSubFrameData(unsigned char* data, File* stream, int count);
 int art_writeFrameData(Art* art, File* stream);
 int save_frame(const char* path, unsigned char* data);
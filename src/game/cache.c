@@ -9,22 +9,22 @@
 #include "plib/gnw/memory.h"
 #include "int/sound.h"
 
-static_assert(sizeof(CacheEntry) == 32, "wrong size");
-static_assert(sizeof(Cache) == 84, "wrong size");
+static_assert(sizeof(CacheEntry) == 36, "wrong size");
+static_assert(sizeof(Cache) == 224, "wrong size");
 
-static bool cache_add(Cache* cache, int key, int* indexPtr);
-static bool cache_insert(Cache* cache, CacheEntry* cacheEntry, int index);
-static int cache_find(Cache* cache, int key, int* indexPtr);
+static bool cache_add(Cache* cache, int key, CacheEntry** cacheEntryPtr);
+static bool cache_insert(Cache* cache, CacheEntry* cacheEntry);
+static CacheEntry* cache_find(Cache* cache, int key);
 static int cache_create_item(CacheEntry** cacheEntryPtr);
 static bool cache_init_item(CacheEntry* cacheEntry);
 static bool cache_destroy_item(Cache* cache, CacheEntry* cacheEntry);
 static bool cache_unlock_all(Cache* cache);
-static bool cache_reset_counter(Cache* cache);
 static bool cache_make_room(Cache* cache, int size);
-static bool cache_purge(Cache* cache);
-static bool cache_resize_array(Cache* cache, int newCapacity);
-static int cache_compare_make_room(const void* a1, const void* a2);
-static int cache_compare_reset_counter(const void* a1, const void* a2);
+static void cache_evict(Cache* cache, CacheEntry* cacheEntry);
+static bool cache_resize_buckets(Cache* cache, int newLength);
+static unsigned int cache_hash(Cache* cache, int key);
+static void cache_lru_append(Cache* cache, CacheEntry* cacheEntry);
+static void cache_lru_remove(Cache* cache, CacheEntry* cacheEntry);
 
 // 0x510938
 static int lock_sound_ticker = 0;
@@ -40,18 +40,20 @@ bool cache_init(Cache* cache, CacheSizeProc* sizeProc, CacheReadProc* readProc,
     cache->size = 0;
     cache->maxSize = maxSize;
     cache->entriesLength = 0;
-    cache->entriesCapacity = CACHE_ENTRIES_INITIAL_CAPACITY;
+    cache->bucketsLength = CACHE_BUCKETS_INITIAL_LENGTH;
     cache->hits = 0;
-    cache->entries = (CacheEntry**)mem_malloc(sizeof(*cache->entries) * cache->entriesCapacity);
+    cache->buckets = (CacheEntry**)mem_malloc(sizeof(*cache->buckets) * cache->bucketsLength);
+    cache->lruHead = NULL;
+    cache->lruTail = NULL;
     cache->sizeProc = sizeProc;
     cache->readProc = readProc;
     cache->freeProc = freeProc;
 
-    if (cache->entries == NULL) {
+    if (cache->buckets == NULL) {
         return false;
     }
 
-    memset(cache->entries, 0, sizeof(*cache->entries) * cache->entriesCapacity);
+    memset(cache->buckets, 0, sizeof(*cache->buckets) * cache->bucketsLength);
 
     return true;
 }
@@ -71,14 +73,17 @@ bool cache_exit(Cache* cache)
     cache->size = 0;
     cache->maxSize = 0;
     cache->entriesLength = 0;
-    cache->entriesCapacity = 0;
+    cache->bucketsLength = 0;
     cache->hits = 0;
 
-    if (cache->entries != NULL) {
-        mem_free(cache->entries);
-        cache->entries = NULL;
+    if (cache->buckets != NULL) {
+        mem_free(cache->buckets);
+        cache->buckets = NULL;
     }
 
+    cache->lruHead = NULL;
+    cache->lruTail = NULL;
+
     cache->sizeProc = NULL;
     cache->readProc = NULL;
     cache->freeProc = NULL;
@@ -91,13 +96,11 @@ bool cache_exit(Cache* cache)
 // 0x41FDC0
 int cache_query(Cache* cache, int key)
 {
-    int index;
-
     if (cache == NULL) {
         return 0;
     }
 
-    if (cache_find(cache, key, &index) != 2) {
+    if (cache_find(cache, key) == NULL) {
         return 0;
     }
 
@@ -113,19 +116,17 @@ bool cache_lock(Cache* cache, int key, void** data, CacheEntry** cacheEntryPtr)
 
     *cacheEntryPtr = NULL;
 
-    int index;
-    int rc = cache_find(cache, key, &index);
-    if (rc == 2) {
+    CacheEntry* cacheEntry = cache_find(cache, key);
+    if (cacheEntry != NULL) {
         // Use existing cache entry.
-        CacheEntry* cacheEntry = cache->entries[index];
         cacheEntry->hits++;
-    } else if (rc == 3) {
+    } else {
         // New cache entry is required.
         if (cache->entriesLength >= INT_MAX) {
             return false;
         }
 
-        if (!cache_add(cache, key, &index)) {
+        if (!cache_add(cache, key, &cacheEntry)) {
             return false;
         }
 
@@ -133,25 +134,20 @@ bool cache_lock(Cache* cache, int key, void** data, CacheEntry** cacheEntryPtr)
         if (lock_sound_ticker == 0) {
             soundContinueAll();
         }
-    } else {
-        return false;
     }
 
-    CacheEntry* cacheEntry = cache->entries[index];
     if (cacheEntry->referenceCount == 0) {
         if (!heap_lock(&(cache->heap), cacheEntry->heapHandleIndex, &(cacheEntry->data))) {
             return false;
         }
+
+        // Locked entries are not subject to eviction.
+        cache_lru_remove(cache, cacheEntry);
     }
 
     cacheEntry->referenceCount++;
 
     cache->hits++;
-    cacheEntry->mru = cache->hits;
-
-    if (cache->hits == UINT_MAX) {
-        cache_reset_counter(cache);
-    }
 
     *data = cacheEntry->data;
     *cacheEntryPtr = cacheEntry;
@@ -174,6 +170,9 @@ bool cache_unlock(Cache* cache, CacheEntry* cacheEntry)
 
     if (cacheEntry->referenceCount == 0) {
         heap_unlock(&(cache->heap), cacheEntry->heapHandleIndex);
+
+        // The entry becomes the most recently used eviction candidate.
+        cache_lru_append(cache, cacheEntry);
     }
 
     return true;
@@ -184,25 +183,22 @@ bool cache_unlock(Cache* cache, CacheEntry* cacheEntry)
 // 0x4200EC
 int cache_discard(Cache* cache, int key)
 {
-    int index;
     CacheEntry* cacheEntry;
 
     if (cache == NULL) {
         return 0;
     }
 
-    if (cache_find(cache, key, &index) != 2) {
+    cacheEntry = cache_find(cache, key);
+    if (cacheEntry == NULL) {
         return 0;
     }
 
-    cacheEntry = cache->entries[index];
     if (cacheEntry->referenceCount != 0) {
         return 0;
     }
 
-    cacheEntry->flags |= CACHE_ENTRY_MARKED_FOR_EVICTION;
-
-    cache_purge(cache);
+    cache_evict(cache, cacheEntry);
 
     return 1;
 }
@@ -215,21 +211,19 @@ bool cache_flush(Cache* cache)
         return false;
     }
 
-    // Loop thru cache entries and mark those with no references for eviction.
-    for (int index = 0; index < cache->entriesLength; index++) {
-        CacheEntry* cacheEntry = cache->entries[index];
-        if (cacheEntry->referenceCount == 0) {
-            cacheEntry->flags |= CACHE_ENTRY_MARKED_FOR_EVICTION;
-        }
+    // Evict every entry with no references.
+    while (cache->lruHead != NULL) {
+        cache_evict(cache, cache->lruHead);
     }
 
-    // Sweep cache entries marked earlier.
-    cache_purge(cache);
+    // Shrink hash table if it's too big.
+    int optimalLength = CACHE_BUCKETS_INITIAL_LENGTH;
+    while (optimalLength < cache->entriesLength) {
+        optimalLength *= 2;
+    }
 
-    // Shrink cache entries array if it's too big.
-    int optimalCapacity = cache->entriesLength + CACHE_ENTRIES_GROW_CAPACITY;
-    if (optimalCapacity < cache->entriesCapacity) {
-        cache_resize_array(cache, optimalCapacity);
+    if (optimalLength < cache->bucketsLength) {
+        cache_resize_buckets(cache, optimalLength);
     }
 
     return true;
@@ -270,8 +264,9 @@ bool cache_stats(Cache* cache, char* dest)
 // 0x4201C0
 int cache_create_list(Cache* cache, unsigned int a2, int** tagsPtr, int* tagsLengthPtr)
 {
-    int cacheItemIndex;
+    int bucketIndex;
     int tagIndex;
+    CacheEntry* cacheEntry;
 
     if (cache == NULL) {
         return 0;
@@ -294,39 +289,23 @@ int cache_create_list(Cache* cache, unsigned int a2, int** tagsPtr, int* tagsLen
             return 0;
         }
 
-        for (cacheItemIndex = 0; cacheItemIndex < cache->entriesLength; cacheItemIndex++) {
-            (*tagsPtr)[cacheItemIndex] = cache->entries[cacheItemIndex]->key;
+        tagIndex = 0;
+        for (bucketIndex = 0; bucketIndex < cache->bucketsLength; bucketIndex++) {
+            for (cacheEntry = cache->buckets[bucketIndex]; cacheEntry != NULL; cacheEntry = cacheEntry->bucketNext) {
+                (*tagsPtr)[tagIndex++] = cacheEntry->key;
+            }
         }
 
         *tagsLengthPtr = cache->entriesLength;
 
         break;
     case CACHE_LIST_REQUEST_TYPE_LOCKED_ITEMS:
-        for (cacheItemIndex = 0; cacheItemIndex < cache->entriesLength; cacheItemIndex++) {
-            if (cache->entries[cacheItemIndex]->referenceCount != 0) {
-                (*tagsLengthPtr)++;
-            }
-        }
-
-        *tagsPtr = (int*)mem_malloc(sizeof(*tagsPtr) * (*tagsLengthPtr));
-        if (*tagsPtr == NULL) {
-            return 0;
-        }
-
-        tagIndex = 0;
-        for (cacheItemIndex = 0; cacheItemIndex < cache->entriesLength; cacheItemIndex++) {
-            if (cache->entries[cacheItemIndex]->referenceCount != 0) {
-                if (tagIndex < *tagsLengthPtr) {
-                    (*tagsPtr)[tagIndex++] = cache->entries[cacheItemIndex]->key;
-                }
-            }
-        }
-
-        break;
     case CACHE_LIST_REQUEST_TYPE_UNLOCKED_ITEMS:
-        for (cacheItemIndex = 0; cacheItemIndex < cache->entriesLength; cacheItemIndex++) {
-            if (cache->entries[cacheItemIndex]->referenceCount == 0) {
-                (*tagsLengthPtr)++;
+        for (bucketIndex = 0; bucketIndex < cache->bucketsLength; bucketIndex++) {
+            for (cacheEntry = cache->buckets[bucketIndex]; cacheEntry != NULL; cacheEntry = cacheEntry->bucketNext) {
+                if ((cacheEntry->referenceCount != 0) == (a2 == CACHE_LIST_REQUEST_TYPE_LOCKED_ITEMS)) {
+                    (*tagsLengthPtr)++;
+                }
             }
         }
 
@@ -336,10 +315,12 @@ int cache_create_list(Cache* cache, unsigned int a2, int** tagsPtr, int* tagsLen
         }
 
         tagIndex = 0;
-        for (cacheItemIndex = 0; cacheItemIndex < cache->entriesLength; cacheItemIndex++) {
-            if (cache->entries[cacheItemIndex]->referenceCount == 0) {
-                if (tagIndex < *tagsLengthPtr) {
-                    (*tagsPtr)[tagIndex++] = cache->entries[cacheItemIndex]->key;
+        for (bucketIndex = 0; bucketIndex < cache->bucketsLength; bucketIndex++) {
+            for (cacheEntry = cache->buckets[bucketIndex]; cacheEntry != NULL; cacheEntry = cacheEntry->bucketNext) {
+                if ((cacheEntry->referenceCount != 0) == (a2 == CACHE_LIST_REQUEST_TYPE_LOCKED_ITEMS)) {
+                    if (tagIndex < *tagsLengthPtr) {
+                        (*tagsPtr)[tagIndex++] = cacheEntry->key;
+                    }
                 }
             }
         }
@@ -372,7 +353,7 @@ int cache_destroy_list(int** tagsPtr)
 // Fetches entry for the specified key into the cache.
 //
 // 0x4203AC
-static bool cache_add(Cache* cache, int key, int* indexPtr)
+static bool cache_add(Cache* cache, int key, CacheEntry** cacheEntryPtr)
 {
     CacheEntry* cacheEntry;
 
@@ -438,25 +419,12 @@ static bool cache_add(Cache* cache, int key, int* indexPtr)
             cacheEntry->size = size;
             cacheEntry->key = key;
 
-            bool isNewKey = true;
-            if (*indexPtr < cache->entriesLength) {
-                if (key < cache->entries[*indexPtr]->key) {
-                    if (*indexPtr == 0 || key > cache->entries[*indexPtr - 1]->key) {
-                        isNewKey = false;
-                    }
-                }
-            }
-
-            if (isNewKey) {
-                if (cache_find(cache, key, indexPtr) != 3) {
-                    break;
-                }
-            }
-
-            if (!cache_insert(cache, cacheEntry, *indexPtr)) {
+            if (!cache_insert(cache, cacheEntry)) {
                 break;
             }
 
+            *cacheEntryPtr = cacheEntry;
+
             return true;
         } while (0);
 
@@ -469,68 +437,46 @@ static bool cache_add(Cache* cache, int key, int* indexPtr)
     return false;
 }
 
+// Adds unreferenced [cacheEntry] to the hash table and eviction list.
+//
 // 0x4205E8
-static bool cache_insert(Cache* cache, CacheEntry* cacheEntry, int index)
+static bool cache_insert(Cache* cache, CacheEntry* cacheEntry)
 {
-    // Ensure cache have enough space for new entry.
-    if (cache->entriesLength == cache->entriesCapacity - 1) {
-        if (!cache_resize_array(cache, cache->entriesCapacity + CACHE_ENTRIES_GROW_CAPACITY)) {
+    // Keep load factor at or below one entry per bucket.
+    if (cache->entriesLength >= cache->bucketsLength) {
+        if (!cache_resize_buckets(cache, cache->bucketsLength * 2)) {
             return false;
         }
     }
 
-    // Move entries below insertion point.
-    memmove(&(cache->entries[index + 1]), &(cache->entries[index]), sizeof(*cache->entries) * (cache->entriesLength - index));
+    unsigned int bucketIndex = cache_hash(cache, cacheEntry->key);
+    cacheEntry->bucketNext = cache->buckets[bucketIndex];
+    cache->buckets[bucketIndex] = cacheEntry;
+
+    cache_lru_append(cache, cacheEntry);
 
-    cache->entries[index] = cacheEntry;
     cache->entriesLength++;
     cache->size += cacheEntry->size;
 
     return true;
 }
 
-// Finds index for given key.
+// Finds cache entry for given key.
 //
-// Returns 2 if entry already exists in cache, or 3 if entry does not exist. In
-// this case indexPtr represents insertion point.
+// Returns NULL if entry does not exist.
 //
 // 0x420654
-static int cache_find(Cache* cache, int key, int* indexPtr)
+static CacheEntry* cache_find(Cache* cache, int key)
 {
-    int length = cache->entriesLength;
-    if (length == 0) {
-        *indexPtr = 0;
-        return 3;
-    }
-
-    int r = length - 1;
-    int l = 0;
-    int mid;
-    int cmp;
-
-    do {
-        mid = (l + r) / 2;
-
-        cmp = key - cache->entries[mid]->key;
-        if (cmp == 0) {
-            *indexPtr = mid;
-            return 2;
+    CacheEntry* cacheEntry = cache->buckets[cache_hash(cache, key)];
+    while (cacheEntry != NULL) {
+        if (cacheEntry->key == key) {
+            return cacheEntry;
         }
-
-        if (cmp > 0) {
-            l = l + 1;
-        } else {
-            r = r - 1;
-        }
-    } while (r >= l);
-
-    if (cmp < 0) {
-        *indexPtr = mid;
-    } else {
-        *indexPtr = mid + 1;
+        cacheEntry = cacheEntry->bucketNext;
     }
 
-    return 3;
+    return NULL;
 }
 
 // NOTE: Inlined.
@@ -557,8 +503,9 @@ static bool cache_init_item(CacheEntry* cacheEntry)
     cacheEntry->data = NULL;
     cacheEntry->referenceCount = 0;
     cacheEntry->hits = 0;
-    cacheEntry->flags = 0;
-    cacheEntry->mru = 0;
+    cacheEntry->bucketNext = NULL;
+    cacheEntry->lruPrev = NULL;
+    cacheEntry->lruNext = NULL;
     return true;
 }
 
@@ -580,49 +527,22 @@ static bool cache_destroy_item(Cache* cache, CacheEntry* cacheEntry)
 static bool cache_unlock_all(Cache* cache)
 {
     Heap* heap = &(cache->heap);
-    for (int index = 0; index < cache->entriesLength; index++) {
-        CacheEntry* cacheEntry = cache->entries[index];
-
-        // NOTE: Original code is slightly different. For unknown reason it uses
-        // inner loop to decrement `referenceCount` one by one. Probably using
-        // some inlined function.
-        if (cacheEntry->referenceCount != 0) {
-            heap_unlock(heap, cacheEntry->heapHandleIndex);
-            cacheEntry->referenceCount = 0;
+    for (int bucketIndex = 0; bucketIndex < cache->bucketsLength; bucketIndex++) {
+        for (CacheEntry* cacheEntry = cache->buckets[bucketIndex]; cacheEntry != NULL; cacheEntry = cacheEntry->bucketNext) {
+            // NOTE: Original code is slightly different. For unknown reason it
+            // uses inner loop to decrement `referenceCount` one by one.
+            // Probably using some inlined function.
+            if (cacheEntry->referenceCount != 0) {
+                heap_unlock(heap, cacheEntry->heapHandleIndex);
+                cacheEntry->referenceCount = 0;
+                cache_lru_append(cache, cacheEntry);
+            }
         }
     }
 
     return true;
 }
 
-// 0x4207D4
-static bool cache_reset_counter(Cache* cache)
-{
-    if (cache == NULL) {
-        return false;
-    }
-
-    CacheEntry** entries = (CacheEntry**)mem_malloc(sizeof(*entries) * cache->entriesLength);
-    if (entries == NULL) {
-        return false;
-    }
-
-    memcpy(entries, cache->entries, sizeof(*entries) * cache->entriesLength);
-
-    qsort(entries, cache->entriesLength, sizeof(*entries), cache_compare_reset_counter);
-
-    for (int index = 0; index < cache->entriesLength; index++) {
-        CacheEntry* cacheEntry = entries[index];
-        cacheEntry->mru = index;
-    }
-
-    cache->hits = cache->entriesLength;
-
-    // FIXME: Obviously leak `entries`.
-
-    return true;
-}
-
 // Prepare cache for storing new entry with the specified size.
 //
 // 0x42084C
@@ -639,61 +559,19 @@ static bool cache_make_room(Cache* cache, int size)
         return true;
     }
 
-    CacheEntry** entries = (CacheEntry**)mem_malloc(sizeof(*entries) * cache->entriesLength);
-    if (entries != NULL) {
-        memcpy(entries, cache->entries, sizeof(*entries) * cache->entriesLength);
-        qsort(entries, cache->entriesLength, sizeof(*entries), cache_compare_make_room);
-
-        // The sweeping threshold is 20% of cache size plus size for the new
-        // entry. Once the threshold is reached the marking process stops.
-        int threshold = size + (int)((double)cache->size * 0.2);
-
-        int accum = 0;
-        int index;
-        for (index = 0; index < cache->entriesLength; index++) {
-            CacheEntry* entry = entries[index];
-            if (entry->referenceCount == 0) {
-                if (entry->size >= threshold) {
-                    entry->flags |= CACHE_ENTRY_MARKED_FOR_EVICTION;
-
-                    // We've just found one huge entry, there is no point to
-                    // mark individual smaller entries in the code path below,
-                    // reset the accumulator to skip it entirely.
-                    accum = 0;
-                    break;
-                } else {
-                    accum += entry->size;
-
-                    if (accum >= threshold) {
-                        break;
-                    }
-                }
-            }
-        }
-
-        if (accum != 0) {
-            // The loop below assumes index to be positioned on the entry, where
-            // accumulator stopped. If we've reached the end, reposition
-            // it to the last entry.
-            if (index == cache->entriesLength) {
-                index -= 1;
-            }
-
-            // Loop backwards from the point we've stopped and mark all
-            // unreferenced entries for sweeping.
-            for (; index >= 0; index--) {
-                CacheEntry* entry = entries[index];
-                if (entry->referenceCount == 0) {
-                    entry->flags |= CACHE_ENTRY_MARKED_FOR_EVICTION;
-                }
-            }
-        }
+    // The sweeping threshold is 20% of cache size plus size for the new
+    // entry. Evicting a bit more than strictly needed leaves room for the
+    // next few entries, so that eviction does not happen on every miss.
+    int threshold = size + (int)((double)cache->size * 0.2);
 
-        mem_free(entries);
+    // Evict least recently used entries until threshold is reached. Locked
+    // entries are not in the list, so every visited entry is evicted.
+    int accum = 0;
+    while (cache->lruHead != NULL && accum < threshold) {
+        accum += cache->lruHead->size;
+        cache_evict(cache, cache->lruHead);
     }
 
-    cache_purge(cache);
-
     if (cache->maxSize - cache->size >= size) {
         return true;
     }
@@ -701,95 +579,97 @@ static bool cache_make_room(Cache* cache, int size)
     return false;
 }
 
-// 0x42099C
-static bool cache_purge(Cache* cache)
+// Removes unreferenced [cacheEntry] from cache and frees it.
+static void cache_evict(Cache* cache, CacheEntry* cacheEntry)
 {
-    for (int index = 0; index < cache->entriesLength; index++) {
-        CacheEntry* cacheEntry = cache->entries[index];
-        if ((cacheEntry->flags & CACHE_ENTRY_MARKED_FOR_EVICTION) != 0) {
-            if (cacheEntry->referenceCount != 0) {
-                // Entry was marked for eviction but still has references,
-                // unmark it.
-                cacheEntry->flags &= ~CACHE_ENTRY_MARKED_FOR_EVICTION;
-            } else {
-                int cacheEntrySize = cacheEntry->size;
-
-                // NOTE: Uninline.
-                cache_destroy_item(cache, cacheEntry);
-
-                // Move entries up.
-                memmove(&(cache->entries[index]), &(cache->entries[index + 1]), sizeof(*cache->entries) * ((cache->entriesLength - index) - 1));
+    CacheEntry** link = &(cache->buckets[cache_hash(cache, cacheEntry->key)]);
+    while (*link != cacheEntry) {
+        link = &((*link)->bucketNext);
+    }
+    *link = cacheEntry->bucketNext;
 
-                cache->entriesLength--;
-                cache->size -= cacheEntrySize;
+    cache_lru_remove(cache, cacheEntry);
 
-                // The entry was removed, compensate index.
-                index--;
-            }
-        }
-    }
+    cache->entriesLength--;
+    cache->size -= cacheEntry->size;
 
-    return true;
+    // NOTE: Uninline.
+    cache_destroy_item(cache, cacheEntry);
 }
 
-// 0x420A40
-static bool cache_resize_array(Cache* cache, int newCapacity)
+// Rebuilds hash table with [newLength] buckets.
+static bool cache_resize_buckets(Cache* cache, int newLength)
 {
-    if (newCapacity < cache->entriesLength) {
+    CacheEntry** buckets = (CacheEntry**)mem_malloc(sizeof(*buckets) * newLength);
+    if (buckets == NULL) {
         return false;
     }
 
-    CacheEntry** entries = (CacheEntry**)mem_realloc(cache->entries, sizeof(*cache->entries) * newCapacity);
-    if (entries == NULL) {
-        return false;
+    memset(buckets, 0, sizeof(*buckets) * newLength);
+
+    CacheEntry** oldBuckets = cache->buckets;
+    int oldLength = cache->bucketsLength;
+
+    cache->buckets = buckets;
+    cache->bucketsLength = newLength;
+
+    for (int bucketIndex = 0; bucketIndex < oldLength; bucketIndex++) {
+        CacheEntry* cacheEntry = oldBuckets[bucketIndex];
+        while (cacheEntry != NULL) {
+            CacheEntry* next = cacheEntry->bucketNext;
+
+            unsigned int newBucketIndex = cache_hash(cache, cacheEntry->key);
+            cacheEntry->bucketNext = buckets[newBucketIndex];
+            buckets[newBucketIndex] = cacheEntry;
+
+            cacheEntry = next;
+        }
     }
 
-    cache->entries = entries;
-    cache->entriesCapacity = newCapacity;
+    mem_free(oldBuckets);
 
     return true;
 }
 
-// 0x420A74
-static int cache_compare_make_room(const void* a1, const void* a2)
+// Returns bucket index for [key].
+static unsigned int cache_hash(Cache* cache, int key)
 {
-    CacheEntry* v1 = *(CacheEntry**)a1;
-    CacheEntry* v2 = *(CacheEntry**)a2;
-
-    if (v1->referenceCount != 0 && v2->referenceCount == 0) {
-        return 1;
-    }
-
-    if (v2->referenceCount != 0 && v1->referenceCount == 0) {
-        return -1;
-    }
+    // Keys are mostly FIDs, which differ in a handful of bit ranges. Fibonacci
+    // hashing spreads them evenly across buckets.
+    unsigned int hash = (unsigned int)key * 2654435769U;
+    return (hash ^ (hash >> 16)) & (cache->bucketsLength - 1);
+}
 
-    if (v1->hits < v2->hits) {
-        return -1;
-    } else if (v1->hits > v2->hits) {
-        return 1;
-    }
+// Appends [cacheEntry] to the tail (most recently used end) of eviction list.
+static void cache_lru_append(Cache* cache, CacheEntry* cacheEntry)
+{
+    cacheEntry->lruPrev = cache->lruTail;
+    cacheEntry->lruNext = NULL;
 
-    if (v1->mru < v2->mru) {
-        return -1;
-    } else if (v1->mru > v2->mru) {
-        return 1;
+    if (cache->lruTail != NULL) {
+        cache->lruTail->lruNext = cacheEntry;
+    } else {
+        cache->lruHead = cacheEntry;
     }
 
-    return 0;
+    cache->lruTail = cacheEntry;
 }
 
-// 0x420AE8
-static int cache_compare_reset_counter(const void* a1, const void* a2)
+// Removes [cacheEntry] from eviction list.
+static void cache_lru_remove(Cache* cache, CacheEntry* cacheEntry)
 {
-    CacheEntry* v1 = *(CacheEntry**)a1;
-    CacheEntry* v2 = *(CacheEntry**)a2;
+    if (cacheEntry->lruPrev != NULL) {
+        cacheEntry->lruPrev->lruNext = cacheEntry->lruNext;
+    } else {
+        cache->lruHead = cacheEntry->lruNext;
+    }
 
-    if (v1->mru < v2->mru) {
-        return 1;
-    } else if (v1->mru > v2->mru) {
-        return -1;
+    if (cacheEntry->lruNext != NULL) {
+        cacheEntry->lruNext->lruPrev = cacheEntry->lruPrev;
     } else {
-        return 0;
+        cache->lruTail = cacheEntry->lruPrev;
     }
+
+    cacheEntry->lruPrev = NULL;
+    cacheEntry->lruNext = NULL;
 }
@@ -7,17 +7,8 @@
 
 #define INVALID_CACHE_ENTRY ((CacheEntry*)-1)
 
-// The initial number of cache entries in new cache.
-#define CACHE_ENTRIES_INITIAL_CAPACITY 100
-
-// The number of cache entries added when cache capacity is reached.
-#define CACHE_ENTRIES_GROW_CAPACITY 50
-
-typedef enum CacheEntryFlags {
-    // Specifies that cache entry has no references as should be evicted during
-    // the next sweep operation.
-    CACHE_ENTRY_MARKED_FOR_EVICTION = 0x01,
-} CacheEntryFlags;
+// The initial number of hash buckets in new cache. Must be a power of two.
+#define CACHE_BUCKETS_INITIAL_LENGTH 128
 
 typedef enum CacheListRequestType {
     CACHE_LIST_REQUEST_TYPE_ALL_ITEMS = 0,
@@ -39,13 +30,15 @@ typedef struct CacheEntry {
     // lifetime.
     unsigned int hits;
 
-    unsigned int flags;
+    int heapHandleIndex;
 
-    // The most recent hit in terms of cache hit counter. Used to track most
-    // recently used entries in eviction strategy.
-    unsigned int mru;
+    // Next entry in the same hash bucket.
+    struct CacheEntry* bucketNext;
 
-    int heapHandleIndex;
+    // Previous and next entries in the list of unreferenced entries (see
+    // [Cache.lruHead]). Both values are NULL while entry is locked.
+    struct CacheEntry* lruPrev;
+    struct CacheEntry* lruNext;
 } CacheEntry;
 
 typedef struct Cache {
@@ -55,17 +48,24 @@ typedef struct Cache {
     // Maximum size of entries in cache.
     int maxSize;
 
-    // The length of `entries` array.
+    // The number of entries in cache.
     int entriesLength;
 
-    // The capacity of `entries` array.
-    int entriesCapacity;
+    // The length of `buckets` array, always a power of two.
+    int bucketsLength;
 
     // Total number of hits during cache lifetime.
     unsigned int hits;
 
-    // List of cache entries.
-    CacheEntry** entries;
+    // Hash table of cache entries keyed by `key`. Entries in the same bucket
+    // are chained via `bucketNext`.
+    CacheEntry** buckets;
+
+    // The list of entries with no references, ordered from the least
+    // recently used (head) to the most recently used (tail). These are the
+    // only entries which can be evicted.
+    CacheEntry* lruHead;
+    CacheEntry* lruTail;
 
     CacheSizeProc* sizeProc;
     CacheReadProc* readProc;
@@ -2190,6 +2190,7 @@ static int ai_move_steps_closer(Object* a1, Object* a2, int actionPoints, int a4
     if ((a2->flags & 0x800) != 0) {
         shouldUnhide = true;
         a2->flags |= OBJECT_HIDDEN;
+        obj_invalidate_blockers(a2->elevation);
     } else {
         shouldUnhide = false;
     }
@@ -2201,12 +2202,14 @@ static int ai_move_steps_closer(Object* a1, Object* a2, int actionPoints, int a4
             && PID_TYPE(moveBlockObj->pid) == OBJ_TYPE_CRITTER) {
             if (shouldUnhide) {
                 a2->flags &= ~OBJECT_HIDDEN;
+                obj_invalidate_blockers(a2->elevation);
             }
 
             a2 = moveBlockObj;
             if ((a2->flags & 0x800) != 0) {
                 shouldUnhide = true;
                 a2->flags |= OBJECT_HIDDEN;
+                obj_invalidate_blockers(a2->elevation);
             } else {
                 shouldUnhide = false;
             }
@@ -2215,6 +2218,7 @@ static int ai_move_steps_closer(Object* a1, Object* a2, int actionPoints, int a4
 
     if (shouldUnhide) {
         a2->flags &= ~OBJECT_HIDDEN;
+        obj_invalidate_blockers(a2->elevation);
     }
 
     int tile = a2->tile;
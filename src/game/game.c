@@ -868,6 +868,14 @@ int game_handle_input(int eventCode, bool isInCombatMode)
     case KEY_ARROW_DOWN:
         map_scroll(0, 1);
         break;
+#ifdef INTERPRET_PROFILE
+    case KEY_CTRL_T:
+        // Dump script statistics collected since the previous dump.
+        interpretProfileDump("profile.csv");
+        interpretProfileReset();
+        display_print("Script profile written to profile.csv");
+        break;
+#endif
     }
 
     return 0;
@@ -1203,12 +1211,16 @@ int game_quit_with_confirm()
 static int game_init_databases()
 {
     int hashing;
+    int mapped_dat;
+    int dat_seek_index;
     char* main_file_name;
     char* patch_file_name;
     int patch_index;
     char filename[MAX_PATH];
 
     hashing = 0;
+    mapped_dat = 0;
+    dat_seek_index = 0;
     main_file_name = NULL;
     patch_file_name = NULL;
 
@@ -1216,6 +1228,14 @@ static int game_init_databases()
         db_enable_hash_table();
     }
 
+    if (config_get_value(&game_config, GAME_CONFIG_SYSTEM_KEY, GAME_CONFIG_MAPPED_DAT_KEY, &mapped_dat) && mapped_dat != 0) {
+        db_enable_mapping();
+    }
+
+    if (config_get_value(&game_config, GAME_CONFIG_SYSTEM_KEY, GAME_CONFIG_DAT_SEEK_INDEX_KEY, &dat_seek_index) && dat_seek_index != 0) {
+        db_enable_seek_index();
+    }
+
     config_get_string(&game_config, GAME_CONFIG_SYSTEM_KEY, GAME_CONFIG_MASTER_DAT_KEY, &main_file_name);
     if (*main_file_name == '\0') {
         main_file_name = NULL;
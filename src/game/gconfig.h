@@ -27,6 +27,8 @@
 #define GAME_CONFIG_COLOR_CYCLING_KEY "color_cycling"
 #define GAME_CONFIG_CYCLE_SPEED_FACTOR_KEY "cycle_speed_factor"
 #define GAME_CONFIG_HASHING_KEY "hashing"
+#define GAME_CONFIG_MAPPED_DAT_KEY "mapped_dat"
+#define GAME_CONFIG_DAT_SEEK_INDEX_KEY "dat_seek_index"
 #define GAME_CONFIG_SPLASH_KEY "splash"
 #define GAME_CONFIG_FREE_SPACE_KEY "free_space"
 #define GAME_CONFIG_TIMES_RUN_KEY "times_run"
@@ -32,6 +32,10 @@
 // The minimum size of block for splitting.
 #define HEAP_BLOCK_MIN_SIZE (128 + HEAP_BLOCK_OVERHEAD_SIZE)
 
+// The granularity of block data size. Every block is large enough to hold
+// [HeapFreeBlockLinks] when it's released.
+#define HEAP_BLOCK_SIZE_ALIGNMENT (4)
+
 #define HEAP_HANDLE_STATE_INVALID (-1)
 
 // The only allowed combination is LOCKED | SYSTEM.
@@ -51,8 +55,19 @@ typedef struct HeapBlockHeader {
 
 typedef struct HeapBlockFooter {
     int guard;
+
+    // Copy of the [HeapBlockHeader.size], used to find the beginning of the
+    // block from the beginning of the next one when coalescing free blocks.
+    int size;
 } HeapBlockFooter;
 
+// Links of the free block in it's segregated free list (see [Heap.freeBins]).
+// They are stored in the data area of the free block.
+typedef struct HeapFreeBlockLinks {
+    unsigned char* prev;
+    unsigned char* next;
+} HeapFreeBlockLinks;
+
 typedef struct HeapMoveableExtent {
     // Pointer to the first block in the extent.
     unsigned char* data;
@@ -69,10 +84,11 @@ typedef struct HeapMoveableExtent {
 } HeapMoveableExtent;
 
 static_assert(sizeof(HeapBlockHeader) == 16, "wrong size");
-static_assert(sizeof(HeapBlockFooter) == 4, "wrong size");
+static_assert(sizeof(HeapBlockFooter) == 8, "wrong size");
+static_assert(sizeof(HeapFreeBlockLinks) == 8, "wrong size");
 static_assert(sizeof(HeapMoveableExtent) == 16, "wrong size");
 static_assert(sizeof(HeapHandle) == 8, "wrong size");
-static_assert(sizeof(Heap) == 48, "wrong size");
+static_assert(sizeof(Heap) == 180, "wrong size");
 
 static bool heap_create_lists();
 static void heap_destroy_lists();
@@ -92,6 +108,12 @@ static bool heap_build_subblock_list(int extentIndex);
 static bool heap_sort_subblock_list(size_t count);
 static int heap_qsort_compare_subblock(const void* a1, const void* a2);
 static bool heap_build_fake_move_list(size_t count);
+static int heap_bin_index(int size);
+static void heap_bin_insert(Heap* heap, unsigned char* block);
+static void heap_bin_remove(Heap* heap, unsigned char* block);
+static unsigned char* heap_bin_find(Heap* heap, int size);
+static void heap_rebuild_bins(Heap* heap);
+static unsigned char* heap_coalesce_free_block(Heap* heap, unsigned char* block);
 
 // An array of pointers to free heap blocks.
 //
@@ -173,6 +195,9 @@ bool heap_init(Heap* heap, int a2)
 
             HeapBlockFooter* blockFooter = (HeapBlockFooter*)(heap->data + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
             blockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+            blockFooter->size = blockHeader->size;
+
+            heap_bin_insert(heap, heap->data);
 
             heap_count++;
 
@@ -234,6 +259,12 @@ bool heap_allocate(Heap* heap, int* handleIndexPtr, int size, int a4)
         a4 = 0;
     }
 
+    // Make sure the block can be linked into free list once it's released.
+    size = (size + HEAP_BLOCK_SIZE_ALIGNMENT - 1) & ~(HEAP_BLOCK_SIZE_ALIGNMENT - 1);
+    if (size < (int)sizeof(HeapFreeBlockLinks)) {
+        size = sizeof(HeapFreeBlockLinks);
+    }
+
     void* block;
     if (!heap_find_free_block(heap, size, &block, a4)) {
         goto err;
@@ -268,6 +299,8 @@ bool heap_allocate(Heap* heap, int* handleIndexPtr, int size, int a4)
     }
 
     if (state == HEAP_BLOCK_STATE_FREE) {
+        heap_bin_remove(heap, (unsigned char*)block);
+
         int remainingSize = blockSize - size;
         if (remainingSize > HEAP_BLOCK_MIN_SIZE) {
             // The block we've just found is big enough for splitting, first
@@ -278,6 +311,7 @@ bool heap_allocate(Heap* heap, int* handleIndexPtr, int size, int a4)
             //
             HeapBlockFooter* blockFooter = (HeapBlockFooter*)((unsigned char*)block + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
             blockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+            blockFooter->size = blockHeader->size;
 
             // Obtain beginning of the next block.
             unsigned char* nextBlock = (unsigned char*)block + blockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
@@ -292,6 +326,11 @@ bool heap_allocate(Heap* heap, int* handleIndexPtr, int size, int a4)
             // ... and footer.
             HeapBlockFooter* nextBlockFooter = (HeapBlockFooter*)(nextBlock + nextBlockHeader->size + HEAP_BLOCK_HEADER_SIZE);
             nextBlockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+            nextBlockFooter->size = nextBlockHeader->size;
+
+            // The block following the remainder cannot be free (adjacent free
+            // blocks are always coalesced), so it goes straight to it's list.
+            heap_bin_insert(heap, nextBlock);
 
             // Update heap stats
             heap->freeBlocks++;
@@ -380,6 +419,8 @@ bool heap_deallocate(Heap* heap, int* handleIndexPtr)
         heap->freeSize += size;
         heap->moveableSize -= size;
 
+        heap_bin_insert(heap, heap_coalesce_free_block(heap, handle->data));
+
         // NOTE: Uninline.
         heap_release_handle(heap, handleIndex);
 
@@ -542,6 +583,11 @@ bool heap_validate(Heap* heap)
             return false;
         }
 
+        if (blockFooter->size != blockHeader->size) {
+            debug_printf("Bad block size detected during validate.\n");
+            return false;
+        }
+
         if (blockHeader->state == HEAP_BLOCK_STATE_FREE) {
             freeBlocks++;
             freeSize += blockHeader->size;
@@ -592,6 +638,26 @@ bool heap_validate(Heap* heap)
         return false;
     }
 
+    int binnedBlocks = 0;
+    for (int binIndex = 0; binIndex < HEAP_FREE_BINS_LENGTH; binIndex++) {
+        unsigned char* block = heap->freeBins[binIndex];
+        while (block != NULL) {
+            HeapBlockHeader* blockHeader = (HeapBlockHeader*)block;
+            if (blockHeader->state != HEAP_BLOCK_STATE_FREE || heap_bin_index(blockHeader->size) != binIndex) {
+                debug_printf("Invalid block in free list.\n");
+                return false;
+            }
+
+            binnedBlocks++;
+            block = ((HeapFreeBlockLinks*)(block + HEAP_BLOCK_HEADER_SIZE))->next;
+        }
+    }
+
+    if (binnedBlocks != heap->freeBlocks) {
+        debug_printf("Invalid number of blocks in free lists.\n");
+        return false;
+    }
+
     debug_printf("Heap is O.K.\n");
 
     int systemBlocks = 0;
@@ -835,11 +901,20 @@ static bool heap_find_free_block(Heap* heap, int size, void** blockPtr, int a4)
     HeapBlockHeader* blockHeader;
     HeapBlockFooter* blockFooter;
 
-    if (!heap_build_free_list(heap)) {
+    if (size > heap->freeSize) {
         goto system;
     }
 
-    if (size > heap->freeSize) {
+    // Most of the requests are served from segregated free lists without
+    // touching the rest of the heap.
+    *blockPtr = heap_bin_find(heap, size);
+    if (*blockPtr != NULL) {
+        return true;
+    }
+
+    // There is enough free space in total, but it's fragmented. Fall back to
+    // moving blocks around to make a free block big enough.
+    if (!heap_build_free_list(heap)) {
         goto system;
     }
 
@@ -851,23 +926,6 @@ static bool heap_find_free_block(Heap* heap, int size, void** blockPtr, int a4)
     biggestFreeBlockHeader = (HeapBlockHeader*)biggestFreeBlock;
     biggestFreeBlockSize = biggestFreeBlockHeader->size;
 
-    // Make sure it can encompass new block of given size.
-    if (biggestFreeBlockSize >= size) {
-        // Now loop thru all free blocks and find the first one that's at least
-        // as large as what was required.
-        int index;
-        for (index = 0; index < heap->freeBlocks; index++) {
-            unsigned char* block = heap_free_list[index];
-            HeapBlockHeader* blockHeader = (HeapBlockHeader*)block;
-            if (blockHeader->size >= size) {
-                break;
-            }
-        }
-
-        *blockPtr = heap_free_list[index];
-        return true;
-    }
-
     int moveableExtentsCount;
     int maxBlocksCount;
     if (!heap_build_moveable_list(heap, &moveableExtentsCount, &maxBlocksCount)) {
@@ -1019,6 +1077,7 @@ static bool heap_find_free_block(Heap* heap, int size, void** blockPtr, int a4)
                 freeBlockHeader->size += remainingSize;
                 HeapBlockFooter* freeBlockFooter = (HeapBlockFooter*)(freeBlock + freeBlockHeader->size + HEAP_BLOCK_HEADER_SIZE);
                 freeBlockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+                freeBlockFooter->size = freeBlockHeader->size;
 
                 // The remaining size of the free block was merged into moveable
                 // block, update heap stats accordingly.
@@ -1028,8 +1087,8 @@ static bool heap_find_free_block(Heap* heap, int size, void** blockPtr, int a4)
                 // The remaining size is enough for a new block. The current
                 // block is already properly formatted - it's header and
                 // footer was copied from moveable block. Since this was a valid
-                // free block it also has it's footer already in place. So the
-                // only thing left is header.
+                // free block it also has it's footer already in place, but the
+                // size stored there is stale.
                 unsigned char* nextFreeBlock = freeBlock + freeBlockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
                 HeapBlockHeader* nextFreeBlockHeader = (HeapBlockHeader*)nextFreeBlock;
                 nextFreeBlockHeader->state = HEAP_BLOCK_STATE_FREE;
@@ -1037,6 +1096,9 @@ static bool heap_find_free_block(Heap* heap, int size, void** blockPtr, int a4)
                 nextFreeBlockHeader->size = remainingSize - HEAP_BLOCK_OVERHEAD_SIZE;
                 nextFreeBlockHeader->guard = HEAP_BLOCK_HEADER_GUARD;
 
+                HeapBlockFooter* nextFreeBlockFooter = (HeapBlockFooter*)(nextFreeBlock + nextFreeBlockHeader->size + HEAP_BLOCK_HEADER_SIZE);
+                nextFreeBlockFooter->size = nextFreeBlockHeader->size;
+
                 heap->freeBlocks++;
                 heap->freeSize -= HEAP_BLOCK_OVERHEAD_SIZE;
             }
@@ -1055,6 +1117,10 @@ static bool heap_find_free_block(Heap* heap, int size, void** blockPtr, int a4)
 
     blockFooter = (HeapBlockFooter*)(extent->data + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
     blockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+    blockFooter->size = blockHeader->size;
+
+    // Moving blocks has overwritten links of the free blocks involved.
+    heap_rebuild_bins(heap);
 
     *blockPtr = extent->data;
 
@@ -1084,6 +1150,7 @@ system:
 
             HeapBlockFooter* blockFooter = (HeapBlockFooter*)(block + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
             blockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+            blockFooter->size = blockHeader->size;
 
             *blockPtr = block;
 
@@ -1143,6 +1210,9 @@ static bool heap_build_free_list(Heap* heap)
                 blocksLength--;
             }
 
+            HeapBlockFooter* blockFooter = (HeapBlockFooter*)(ptr + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
+            blockFooter->size = blockHeader->size;
+
             heap_free_list[freeBlockIndex++] = ptr;
         }
 
@@ -1341,3 +1411,160 @@ static bool heap_build_fake_move_list(size_t count)
 
     return true;
 }
+
+// Returns index of segregated free list for free block of given size.
+static int heap_bin_index(int size)
+{
+    int index = 0;
+    while (size > 1) {
+        size >>= 1;
+        index++;
+    }
+    return index;
+}
+
+// Adds free block to the head of it's segregated free list.
+static void heap_bin_insert(Heap* heap, unsigned char* block)
+{
+    HeapBlockHeader* blockHeader = (HeapBlockHeader*)block;
+    int index = heap_bin_index(blockHeader->size);
+
+    HeapFreeBlockLinks* links = (HeapFreeBlockLinks*)(block + HEAP_BLOCK_HEADER_SIZE);
+    links->prev = NULL;
+    links->next = heap->freeBins[index];
+
+    if (links->next != NULL) {
+        ((HeapFreeBlockLinks*)(links->next + HEAP_BLOCK_HEADER_SIZE))->prev = block;
+    }
+
+    heap->freeBins[index] = block;
+    heap->freeBinsMask |= 1U << index;
+}
+
+// Removes free block from it's segregated free list.
+static void heap_bin_remove(Heap* heap, unsigned char* block)
+{
+    HeapBlockHeader* blockHeader = (HeapBlockHeader*)block;
+    int index = heap_bin_index(blockHeader->size);
+
+    HeapFreeBlockLinks* links = (HeapFreeBlockLinks*)(block + HEAP_BLOCK_HEADER_SIZE);
+    if (links->prev != NULL) {
+        ((HeapFreeBlockLinks*)(links->prev + HEAP_BLOCK_HEADER_SIZE))->next = links->next;
+    } else {
+        heap->freeBins[index] = links->next;
+        if (links->next == NULL) {
+            heap->freeBinsMask &= ~(1U << index);
+        }
+    }
+
+    if (links->next != NULL) {
+        ((HeapFreeBlockLinks*)(links->next + HEAP_BLOCK_HEADER_SIZE))->prev = links->prev;
+    }
+}
+
+// Finds free block which is at least [size] bytes, or returns NULL if there
+// is no such block.
+static unsigned char* heap_bin_find(Heap* heap, int size)
+{
+    int index = heap_bin_index(size);
+
+    // Blocks in the same size class as requested size are not necessarily big
+    // enough, look thru them for the first one that is.
+    unsigned char* block = heap->freeBins[index];
+    while (block != NULL) {
+        HeapBlockHeader* blockHeader = (HeapBlockHeader*)block;
+        if (blockHeader->size >= size) {
+            return block;
+        }
+
+        block = ((HeapFreeBlockLinks*)(block + HEAP_BLOCK_HEADER_SIZE))->next;
+    }
+
+    // Any block from larger size classes is good enough, take the first one
+    // from the smallest non-empty class.
+    for (index++; index < HEAP_FREE_BINS_LENGTH; index++) {
+        if ((heap->freeBinsMask & (1U << index)) != 0) {
+            return heap->freeBins[index];
+        }
+    }
+
+    return NULL;
+}
+
+// Rebuilds segregated free lists from scratch by walking entire heap.
+static void heap_rebuild_bins(Heap* heap)
+{
+    memset(heap->freeBins, 0, sizeof(heap->freeBins));
+    heap->freeBinsMask = 0;
+
+    unsigned char* ptr = heap->data;
+    unsigned char* end = heap->data + heap->size;
+    while (ptr < end) {
+        HeapBlockHeader* blockHeader = (HeapBlockHeader*)ptr;
+        if (blockHeader->state == HEAP_BLOCK_STATE_FREE) {
+            // Join consecutive free blocks if any.
+            while (ptr + blockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE < end) {
+                HeapBlockHeader* nextBlockHeader = (HeapBlockHeader*)(ptr + blockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE);
+                if (nextBlockHeader->state != HEAP_BLOCK_STATE_FREE) {
+                    break;
+                }
+
+                blockHeader->size += nextBlockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
+
+                heap->freeBlocks--;
+                heap->freeSize += HEAP_BLOCK_OVERHEAD_SIZE;
+            }
+
+            HeapBlockFooter* blockFooter = (HeapBlockFooter*)(ptr + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
+            blockFooter->size = blockHeader->size;
+
+            heap_bin_insert(heap, ptr);
+        }
+
+        ptr += blockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
+    }
+}
+
+// Merges just released block with adjacent free blocks (removing them from
+// their free lists). Returns the beginning of the resulting free block, which
+// is not yet linked into any free list.
+static unsigned char* heap_coalesce_free_block(Heap* heap, unsigned char* block)
+{
+    HeapBlockHeader* blockHeader = (HeapBlockHeader*)block;
+
+    unsigned char* nextBlock = block + blockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
+    if (nextBlock < heap->data + heap->size) {
+        HeapBlockHeader* nextBlockHeader = (HeapBlockHeader*)nextBlock;
+        if (nextBlockHeader->state == HEAP_BLOCK_STATE_FREE) {
+            heap_bin_remove(heap, nextBlock);
+
+            blockHeader->size += nextBlockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
+
+            heap->freeBlocks--;
+            heap->freeSize += HEAP_BLOCK_OVERHEAD_SIZE;
+        }
+    }
+
+    if (block > heap->data) {
+        HeapBlockFooter* prevBlockFooter = (HeapBlockFooter*)(block - HEAP_BLOCK_FOOTER_SIZE);
+        unsigned char* prevBlock = block - prevBlockFooter->size - HEAP_BLOCK_OVERHEAD_SIZE;
+        HeapBlockHeader* prevBlockHeader = (HeapBlockHeader*)prevBlock;
+        if (prevBlockHeader->state == HEAP_BLOCK_STATE_FREE) {
+            heap_bin_remove(heap, prevBlock);
+
+            prevBlockHeader->size += blockHeader->size + HEAP_BLOCK_OVERHEAD_SIZE;
+
+            heap->freeBlocks--;
+            heap->freeSize += HEAP_BLOCK_OVERHEAD_SIZE;
+
+            block = prevBlock;
+            blockHeader = prevBlockHeader;
+        }
+    }
+
+    HeapBlockFooter* blockFooter = (HeapBlockFooter*)(block + blockHeader->size + HEAP_BLOCK_HEADER_SIZE);
+    blockFooter->guard = HEAP_BLOCK_FOOTER_GUARD;
+    blockFooter->size = blockHeader->size;
+
+    return block;
+}
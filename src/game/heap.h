@@ -3,6 +3,10 @@
 
 #include <stdbool.h>
 
+// The number of segregated free lists in [Heap]. Free list at index `n` holds
+// free blocks with data size in [2^n, 2^(n+1)) range.
+#define HEAP_FREE_BINS_LENGTH (32)
+
 typedef struct HeapHandle {
     unsigned int state;
     unsigned char* data;
@@ -21,6 +25,13 @@ typedef struct Heap {
     int systemSize;
     HeapHandle* handles;
     unsigned char* data;
+
+    // Bitmask of non-empty lists in [freeBins].
+    unsigned int freeBinsMask;
+
+    // Heads of the segregated free lists. Free blocks in the same list are
+    // linked via [HeapFreeBlockLinks] stored in their data area.
+    unsigned char* freeBins[HEAP_FREE_BINS_LENGTH];
 } Heap;
 
 bool heap_init(Heap* heap, int a2);
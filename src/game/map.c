@@ -1472,6 +1472,9 @@ int map_save_in_game(bool a1)
             map_data.name[0] = '\0';
             obj_remove_all();
             proto_remove_all();
+            tile_dump_refresh_stats();
+            make_path_dump_cache_stats();
+            interpretDumpImageStats();
             square_reset();
             gtime_q_add();
         }
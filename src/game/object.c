@@ -3,6 +3,10 @@
 #include <assert.h>
 #include <string.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include "game/anim.h"
 #include "game/art.h"
 #include "plib/color/color.h"
@@ -25,6 +29,7 @@
 #include "game/textobj.h"
 #include "game/tile.h"
 #include "game/worldmap.h"
+#include "mmx.h"
 #include "plib/gnw/svga.h"
 
 static int obj_read_obj(Object* obj, File* stream);
@@ -55,6 +60,7 @@ static int obj_adjust_light(Object* obj, int a2, Rect* rect);
 static void obj_render_outline(Object* object, Rect* rect);
 static void obj_render_object(Object* object, Rect* rect, int light);
 static int obj_preload_sort(const void* a1, const void* a2);
+static int obj_next_occupied_tile(int tile);
 
 // 0x5195F8
 static bool objInitialized = false;
@@ -224,6 +230,12 @@ static Rect updateAreaPixelBounds;
 // 0x639DA0
 static ObjectListNode* objectTable[HEX_GRID_SIZE];
 
+// Bitset of tiles which may have objects in [objectTable]. Bits are set by
+// [obj_insert] and cleared lazily by [obj_next_occupied_tile] once it finds
+// the tile empty, so there is no need to track every place which unlinks
+// objects from the table.
+static unsigned int objectTableOccupied[HEX_GRID_SIZE / 32];
+
 // 0x660EA0
 unsigned char glassGrayTable[256];
 
@@ -259,6 +271,10 @@ static char obj_seen_check[5001];
 // 0x662445
 static char obj_seen[5001];
 
+// Per-elevation counters of changes which might affect movement blocking
+// (objects being added, removed, moved, hidden, locked, etc.).
+static unsigned int obj_blocker_generation[ELEVATION_COUNT];
+
 // obj_init
 // 0x488780
 int obj_init(unsigned char* buf, int width, int height, int pitch)
@@ -277,6 +293,7 @@ int obj_init(unsigned char* buf, int width, int height, int pitch)
     updateHexArea = updateHexWidth * updateHexHeight;
 
     memset(objectTable, 0, sizeof(objectTable));
+    memset(objectTableOccupied, 0, sizeof(objectTableOccupied));
 
     if (obj_offset_table_init() == -1) {
         return -1;
@@ -692,7 +709,7 @@ int obj_save(File* stream)
             return -1;
         }
 
-        for (int tile = 0; tile < HEX_GRID_SIZE; tile++) {
+        for (int tile = obj_next_occupied_tile(0); tile < HEX_GRID_SIZE; tile = obj_next_occupied_tile(tile + 1)) {
             for (ObjectListNode* objectListNode = objectTable[tile]; objectListNode != NULL; objectListNode = objectListNode->next) {
                 Object* object = objectListNode->obj;
                 if (object->elevation != elevation) {
@@ -1115,6 +1132,10 @@ int obj_disconnect(Object* obj, Rect* rect)
         return -1;
     }
 
+    if (obj->tile != -1) {
+        obj_invalidate_blockers(obj->elevation);
+    }
+
     if (obj_adjust_light(obj, 1, rect) == -1) {
         if (rect != NULL) {
             obj_bound(obj, rect);
@@ -1393,6 +1414,10 @@ int obj_move_to_tile(Object* obj, int tile, int elevation, Rect* rect)
     }
 
     int oldElevation = obj->elevation;
+    if (obj->tile != -1) {
+        obj_invalidate_blockers(oldElevation);
+    }
+
     if (prevNode != NULL) {
         prevNode->next = node->next;
     } else {
@@ -1713,7 +1738,7 @@ void obj_rebuild_all_light()
 {
     light_reset_tiles();
 
-    for (int tile = 0; tile < HEX_GRID_SIZE; tile++) {
+    for (int tile = obj_next_occupied_tile(0); tile < HEX_GRID_SIZE; tile = obj_next_occupied_tile(tile + 1)) {
         ObjectListNode* objectListNode = objectTable[tile];
         while (objectListNode != NULL) {
             obj_adjust_light(objectListNode->obj, 0, NULL);
@@ -1840,6 +1865,8 @@ int obj_turn_on(Object* obj, Rect* rect)
     obj->flags &= ~OBJECT_HIDDEN;
     obj->outline &= ~OUTLINE_DISABLED;
 
+    obj_invalidate_blockers(obj->elevation);
+
     if (obj_adjust_light(obj, 0, rect) == -1) {
         if (rect != NULL) {
             obj_bound(obj, rect);
@@ -1876,6 +1903,8 @@ int obj_turn_off(Object* object, Rect* rect)
 
     object->flags |= OBJECT_HIDDEN;
 
+    obj_invalidate_blockers(object->elevation);
+
     if ((object->outline & OUTLINE_TYPE_MASK) != 0) {
         object->outline |= OUTLINE_DISABLED;
     }
@@ -2117,7 +2146,7 @@ void obj_remove_all()
 
     scr_remove_all();
 
-    for (int tile = 0; tile < HEX_GRID_SIZE; tile++) {
+    for (int tile = obj_next_occupied_tile(0); tile < HEX_GRID_SIZE; tile = obj_next_occupied_tile(tile + 1)) {
         node = objectTable[tile];
         prev = NULL;
 
@@ -2152,19 +2181,14 @@ Object* obj_find_first()
 {
     find_elev = 0;
 
-    ObjectListNode* objectListNode;
-    for (find_tile = 0; find_tile < HEX_GRID_SIZE; find_tile++) {
-        objectListNode = objectTable[find_tile];
-        if (objectListNode) {
-            break;
-        }
-    }
-
+    find_tile = obj_next_occupied_tile(0);
     if (find_tile == HEX_GRID_SIZE) {
         find_ptr = NULL;
         return NULL;
     }
 
+    ObjectListNode* objectListNode = objectTable[find_tile];
+
     while (objectListNode != NULL) {
         if (art_get_disable(FID_TYPE(objectListNode->obj->fid)) == 0) {
             find_ptr = objectListNode;
@@ -2188,6 +2212,11 @@ Object* obj_find_next()
 
     while (find_tile < HEX_GRID_SIZE) {
         if (objectListNode == NULL) {
+            find_tile = obj_next_occupied_tile(find_tile);
+            if (find_tile == HEX_GRID_SIZE) {
+                break;
+            }
+
             objectListNode = objectTable[find_tile++];
         }
 
@@ -2211,7 +2240,7 @@ Object* obj_find_first_at(int elevation)
     find_elev = elevation;
     find_tile = 0;
 
-    for (find_tile = 0; find_tile < HEX_GRID_SIZE; find_tile++) {
+    for (find_tile = obj_next_occupied_tile(0); find_tile < HEX_GRID_SIZE; find_tile = obj_next_occupied_tile(find_tile + 1)) {
         ObjectListNode* objectListNode = objectTable[find_tile];
         while (objectListNode != NULL) {
             Object* object = objectListNode->obj;
@@ -2240,6 +2269,11 @@ Object* obj_find_next_at()
 
     while (find_tile < HEX_GRID_SIZE) {
         if (objectListNode == NULL) {
+            find_tile = obj_next_occupied_tile(find_tile);
+            if (find_tile == HEX_GRID_SIZE) {
+                break;
+            }
+
             objectListNode = objectTable[find_tile++];
         }
 
@@ -2305,6 +2339,36 @@ Object* obj_find_next_at_tile()
     return NULL;
 }
 
+// Returns the first tile starting from `tile` which may have objects, or
+// `HEX_GRID_SIZE` if there are no such tiles.
+static int obj_next_occupied_tile(int tile)
+{
+    while (tile < HEX_GRID_SIZE) {
+        unsigned int bits = objectTableOccupied[tile / 32] & (0xFFFFFFFFU << (tile % 32));
+        if (bits == 0) {
+            tile = (tile / 32 + 1) * 32;
+            continue;
+        }
+
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanForward(&bit, bits);
+#else
+        int bit = __builtin_ctz(bits);
+#endif
+
+        tile = (tile / 32) * 32 + bit;
+        if (objectTable[tile] != NULL) {
+            return tile;
+        }
+
+        objectTableOccupied[tile / 32] &= ~(1U << (tile % 32));
+        tile++;
+    }
+
+    return HEX_GRID_SIZE;
+}
+
 // 0x0x48B66C
 void obj_bound(Object* obj, Rect* rect)
 {
@@ -2659,7 +2723,7 @@ int obj_create_list(int tile, int elevation, int objectType, Object*** objectLis
 
     int count = 0;
     if (tile == -1) {
-        for (int index = 0; index < HEX_GRID_SIZE; index++) {
+        for (int index = obj_next_occupied_tile(0); index < HEX_GRID_SIZE; index = obj_next_occupied_tile(index + 1)) {
             ObjectListNode* objectListNode = objectTable[index];
             while (objectListNode != NULL) {
                 Object* obj = objectListNode->obj;
@@ -2694,7 +2758,7 @@ int obj_create_list(int tile, int elevation, int objectType, Object*** objectLis
     }
 
     if (tile == -1) {
-        for (int index = 0; index < HEX_GRID_SIZE; index++) {
+        for (int index = obj_next_occupied_tile(0); index < HEX_GRID_SIZE; index = obj_next_occupied_tile(index + 1)) {
             ObjectListNode* objectListNode = objectTable[index];
             while (objectListNode) {
                 Object* obj = objectListNode->obj;
@@ -2758,32 +2822,7 @@ void translucent_trans_buf_to_buf(unsigned char* src, int srcWidth, int srcHeigh
 // 0x48BEFC
 void dark_trans_buf_to_buf(unsigned char* src, int srcWidth, int srcHeight, int srcPitch, unsigned char* dest, int destX, int destY, int destPitch, int light)
 {
-    unsigned char* sp = src;
-    unsigned char* dp = dest + destPitch * destY + destX;
-
-    int srcStep = srcPitch - srcWidth;
-    int destStep = destPitch - srcWidth;
-    // TODO: Name might be confusing.
-    int lightModifier = light >> 9;
-
-    for (int y = 0; y < srcHeight; y++) {
-        for (int x = 0; x < srcWidth; x++) {
-            unsigned char b = *sp;
-            if (b != 0) {
-                if (b < 0xE5) {
-                    b = intensityColorTable[b][lightModifier];
-                }
-
-                *dp = b;
-            }
-
-            sp++;
-            dp++;
-        }
-
-        sp += srcStep;
-        dp += destStep;
-    }
+    mmxBlitDarkTrans(dest + destPitch * destY + destX, destPitch, src, srcPitch, srcWidth, srcHeight, light);
 }
 
 // 0x48BF88
@@ -2817,35 +2856,7 @@ void dark_translucent_trans_buf_to_buf(unsigned char* src, int srcWidth, int src
 // 0x48C03C
 void intensity_mask_buf_to_buf(unsigned char* src, int srcWidth, int srcHeight, int srcPitch, unsigned char* dest, int destPitch, unsigned char* mask, int maskPitch, int light)
 {
-    int srcStep = srcPitch - srcWidth;
-    int destStep = destPitch - srcWidth;
-    int maskStep = maskPitch - srcWidth;
-    light >>= 9;
-
-    for (int y = 0; y < srcHeight; y++) {
-        for (int x = 0; x < srcWidth; x++) {
-            unsigned char b = *src;
-            if (b != 0) {
-                b = intensityColorTable[b][light];
-                unsigned char m = *mask;
-                if (m != 0) {
-                    unsigned char d = *dest;
-                    int q = intensityColorTable[d][128 - m];
-                    m = intensityColorTable[b][m];
-                    b = colorMixAddTable[m][q];
-                }
-                *dest = b;
-            }
-
-            src++;
-            dest++;
-            mask++;
-        }
-
-        src += srcStep;
-        dest += destStep;
-        mask += maskStep;
-    }
+    mmxBlitIntensityMask(dest, destPitch, src, srcPitch, mask, maskPitch, srcWidth, srcHeight, light);
 }
 
 // 0x48C2B4
@@ -3187,34 +3198,36 @@ void obj_preload_art_cache(int flags)
         v11++;
     }
 
-    CacheEntry* cache_handle;
-    if (art_ptr_lock(*preload_list, &cache_handle) != NULL) {
-        art_ptr_unlock(cache_handle);
-    }
+    // Collect unique fids in the order they should be loaded and let art
+    // preloader decode them in background. This is only a warm up, so it's
+    // skipped entirely when there is no memory for the list.
+    int* fids = (int*)mem_malloc(sizeof(*fids) * (preload_list_index + 4096));
+    if (fids != NULL) {
+        int fidsLength = 0;
+
+        fids[fidsLength++] = *preload_list;
 
-    for (int i = 1; i < v11; i++) {
-        if (preload_list[i - 1] != preload_list[i]) {
-            if (art_ptr_lock(preload_list[i], &cache_handle) != NULL) {
-                art_ptr_unlock(cache_handle);
+        for (int i = 1; i < v11; i++) {
+            if (preload_list[i - 1] != preload_list[i]) {
+                fids[fidsLength++] = preload_list[i];
             }
         }
-    }
 
-    for (int i = 0; i < 4096; i++) {
-        if (arr[i] != 0) {
-            int fid = art_id(OBJ_TYPE_TILE, i, 0, 0, 0);
-            if (art_ptr_lock(fid, &cache_handle) != NULL) {
-                art_ptr_unlock(cache_handle);
+        for (int i = 0; i < 4096; i++) {
+            if (arr[i] != 0) {
+                fids[fidsLength++] = art_id(OBJ_TYPE_TILE, i, 0, 0, 0);
             }
         }
-    }
 
-    for (int i = v11; i < preload_list_index; i++) {
-        if (preload_list[i - 1] != preload_list[i]) {
-            if (art_ptr_lock(preload_list[i], &cache_handle) != NULL) {
-                art_ptr_unlock(cache_handle);
+        for (int i = v11; i < preload_list_index; i++) {
+            if (preload_list[i - 1] != preload_list[i]) {
+                fids[fidsLength++] = preload_list[i];
             }
         }
+
+        art_preload(fids, fidsLength);
+
+        mem_free(fids);
     }
 
     mem_free(preload_list);
@@ -3845,7 +3858,10 @@ static void obj_insert(ObjectListNode* objectListNode)
         Art* art = NULL;
         CacheEntry* cacheHandle = NULL;
 
+        obj_invalidate_blockers(objectListNode->obj->elevation);
+
         objectListNodePtr = &(objectTable[objectListNode->obj->tile]);
+        objectTableOccupied[objectListNode->obj->tile / 32] |= 1U << (objectListNode->obj->tile % 32);
 
         while (*objectListNodePtr != NULL) {
             Object* obj = (*objectListNodePtr)->obj;
@@ -3902,6 +3918,10 @@ static int obj_remove(ObjectListNode* a1, ObjectListNode* a2)
         return -1;
     }
 
+    if (a1->obj->tile != -1) {
+        obj_invalidate_blockers(a1->obj->elevation);
+    }
+
     obj_inven_free(&(a1->obj->data.inventory));
 
     if (a1->obj->sid != -1) {
@@ -5145,6 +5165,31 @@ void obj_fix_violence_settings(int* fid)
     }
 }
 
+// Returns the number of changes which might affect movement blocking on
+// given elevation. The value itself is meaningless, it only can be compared
+// with previously obtained value to tell if anything has changed.
+unsigned int obj_get_blocker_generation(int elevation)
+{
+    if (!elevationIsValid(elevation)) {
+        return 0;
+    }
+
+    return obj_blocker_generation[elevation];
+}
+
+// Notifies that something which might affect movement blocking has changed
+// on given elevation. Invalid elevation means every elevation.
+void obj_invalidate_blockers(int elevation)
+{
+    if (elevationIsValid(elevation)) {
+        obj_blocker_generation[elevation]++;
+    } else {
+        for (int index = 0; index < ELEVATION_COUNT; index++) {
+            obj_blocker_generation[index]++;
+        }
+    }
+}
+
 // 0x48FB08
 static int obj_preload_sort(const void* a1, const void* a2)
 {
@@ -102,5 +102,7 @@ int obj_load_obj(File* stream, Object** objectPtr, int elevation, Object* owner)
 int obj_save_dude(File* stream);
 int obj_load_dude(File* stream);
 void obj_fix_violence_settings(int* fid);
+unsigned int obj_get_blocker_generation(int elevation);
+void obj_invalidate_blockers(int elevation);
 
 #endif /* FALLOUT_GAME_OBJECT_H_ */
@@ -1951,6 +1951,7 @@ int obj_lock(Object* object)
         break;
     case OBJ_TYPE_SCENERY:
         object->data.scenery.door.openFlags |= OBJ_LOCKED;
+        obj_invalidate_blockers(object->elevation);
         break;
     default:
         return -1;
@@ -1972,6 +1973,7 @@ int obj_unlock(Object* object)
         return 0;
     case OBJ_TYPE_SCENERY:
         object->data.scenery.door.openFlags &= ~OBJ_LOCKED;
+        obj_invalidate_blockers(object->elevation);
         return 0;
     }
 
@@ -37,6 +37,10 @@ static int proto_write_scenery_data(SceneryProtoData* scenery_data, int type, Fi
 static int proto_write_protoSubNode(Proto* buf, File* stream);
 static void proto_remove_some_list(int type);
 static void proto_remove_list(int type);
+static ProtoListEntry** proto_list_bucket(ProtoList* protoList, int pid);
+static void proto_list_lru_remove(ProtoList* protoList, ProtoListEntry* entry);
+static void proto_list_lru_append(ProtoList* protoList, ProtoListEntry* entry);
+static void proto_list_remove(ProtoList* protoList, ProtoListEntry* entry);
 static int proto_new_id(int a1);
 
 // 0x51C18C
@@ -44,19 +48,29 @@ char cd_path_base[MAX_PATH];
 
 // 0x51C290
 static ProtoList protolists[11] = {
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 1 },
-    { 0, 0, 0, 0 },
-    { 0, 0, 0, 0 },
-    { 0, 0, 0, 0 },
-    { 0, 0, 0, 0 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 1 },
+    { { 0 }, 0, 0, 0, 0 },
+    { { 0 }, 0, 0, 0, 0 },
+    { { 0 }, 0, 0, 0, 0 },
+    { { 0 }, 0, 0, 0, 0 },
 };
 
+// Number of [proto_ptr] calls since the last [proto_dump_stats].
+static unsigned long long proto_stats_lookups = 0;
+
+// Number of protos loaded from .PRO files since the last [proto_dump_stats].
+static unsigned long long proto_stats_loads = 0;
+
+// Number of protos evicted from cache lists since the last
+// [proto_dump_stats].
+static unsigned long long proto_stats_evictions = 0;
+
 // 0x51C340
 static const size_t proto_sizes[11] = {
     sizeof(ItemProto), // 0x84
@@ -1196,6 +1210,8 @@ void proto_exit()
 {
     int i;
 
+    proto_dump_stats();
+
     for (i = 0; i < 6; i++) {
         proto_remove_list(i);
     }
@@ -1214,8 +1230,9 @@ int proto_header_load()
 {
     for (int index = 0; index < 6; index++) {
         ProtoList* ptr = &(protolists[index]);
-        ptr->head = NULL;
-        ptr->tail = NULL;
+        memset(ptr->buckets, 0, sizeof(ptr->buckets));
+        ptr->lruHead = NULL;
+        ptr->lruTail = NULL;
         ptr->length = 0;
         ptr->max_entries_num = 1;
 
@@ -1670,15 +1687,36 @@ int proto_load_pid(int pid, Proto** protoPtr)
         return -1;
     }
 
+    // NOTE: [proto_find_free_subnode] appends new proto to the end of the
+    // list.
+    ProtoList* protoList = &(protolists[PID_TYPE(pid)]);
+    ProtoListEntry* entry = protoList->lruTail;
+
     if (proto_read_protoSubNode(*protoPtr, stream) != 0) {
         db_fclose(stream);
+        proto_list_remove(protoList, entry);
+        *protoPtr = NULL;
         return -1;
     }
 
     db_fclose(stream);
+
+    // The pid is known only after the proto is read.
+    entry->pid = (*protoPtr)->pid;
+
+    ProtoListEntry** bucket = proto_list_bucket(protoList, entry->pid);
+    entry->bucketNext = *bucket;
+    *bucket = entry;
+
+    proto_stats_loads++;
+
     return 0;
 }
 
+// Allocates new proto of given type and appends it to the end of the cache
+// list. The proto is not accessible via [proto_ptr] until it's inserted into
+// hash table by [proto_load_pid].
+//
 // 0x4A1D98
 int proto_find_free_subnode(int type, Proto** protoPtr)
 {
@@ -1690,64 +1728,33 @@ int proto_find_free_subnode(int type, Proto** protoPtr)
         return -1;
     }
 
-    ProtoList* protoList = &(protolists[type]);
-    ProtoListExtent* protoListExtent = protoList->tail;
-
-    if (protoList->head != NULL) {
-        if (protoListExtent->length == PROTO_LIST_EXTENT_SIZE) {
-            ProtoListExtent* newExtent = protoListExtent->next = (ProtoListExtent*)mem_malloc(sizeof(ProtoListExtent));
-            if (protoListExtent == NULL) {
-                mem_free(proto);
-                *protoPtr = NULL;
-                return -1;
-            }
-
-            newExtent->length = 0;
-            newExtent->next = NULL;
-
-            protoList->tail = newExtent;
-            protoList->length++;
-
-            protoListExtent = newExtent;
-        }
-    } else {
-        protoListExtent = (ProtoListExtent*)mem_malloc(sizeof(ProtoListExtent));
-        if (protoListExtent == NULL) {
-            mem_free(proto);
-            *protoPtr = NULL;
-            return -1;
-        }
-
-        protoListExtent->next = NULL;
-        protoListExtent->length = 0;
-
-        protoList->length = 1;
-        protoList->tail = protoListExtent;
-        protoList->head = protoListExtent;
+    ProtoListEntry* entry = (ProtoListEntry*)mem_malloc(sizeof(*entry));
+    if (entry == NULL) {
+        mem_free(proto);
+        *protoPtr = NULL;
+        return -1;
     }
 
-    protoListExtent->proto[protoListExtent->length] = proto;
-    protoListExtent->length++;
+    entry->proto = proto;
+    entry->pid = -1;
+    entry->bucketNext = NULL;
+
+    ProtoList* protoList = &(protolists[type]);
+    proto_list_lru_append(protoList, entry);
+    protoList->length++;
 
     return 0;
 }
 
-// Evict top most proto cache block.
+// Evict least recently used proto.
 //
 // 0x4A2040
 static void proto_remove_some_list(int type)
 {
     ProtoList* protoList = &(protolists[type]);
-    ProtoListExtent* protoListExtent = protoList->head;
-    if (protoListExtent != NULL) {
-        protoList->length--;
-        protoList->head = protoListExtent->next;
-
-        for (int index = 0; index < protoListExtent->length; index++) {
-            mem_free(protoListExtent->proto[index]);
-        }
-
-        mem_free(protoListExtent);
+    if (protoList->lruHead != NULL) {
+        proto_list_remove(protoList, protoList->lruHead);
+        proto_stats_evictions++;
     }
 }
 
@@ -1758,26 +1765,86 @@ static void proto_remove_list(int type)
 {
     ProtoList* protoList = &(protolists[type]);
 
-    ProtoListExtent* curr = protoList->head;
+    ProtoListEntry* curr = protoList->lruHead;
     while (curr != NULL) {
-        ProtoListExtent* next = curr->next;
-        for (int index = 0; index < curr->length; index++) {
-            mem_free(curr->proto[index]);
-        }
+        ProtoListEntry* next = curr->lruNext;
+        mem_free(curr->proto);
         mem_free(curr);
         curr = next;
     }
 
-    protoList->head = NULL;
-    protoList->tail = NULL;
+    memset(protoList->buckets, 0, sizeof(protoList->buckets));
+    protoList->lruHead = NULL;
+    protoList->lruTail = NULL;
     protoList->length = 0;
 }
 
+// Returns hash bucket of the cache list for given pid.
+static ProtoListEntry** proto_list_bucket(ProtoList* protoList, int pid)
+{
+    // Pids of the same type are sequential, so their index bits are already
+    // evenly distributed.
+    return &(protoList->buckets[(pid & 0xFFFFFF) & (PROTO_LIST_BUCKETS_LENGTH - 1)]);
+}
+
+static void proto_list_lru_remove(ProtoList* protoList, ProtoListEntry* entry)
+{
+    if (entry->lruPrev != NULL) {
+        entry->lruPrev->lruNext = entry->lruNext;
+    } else {
+        protoList->lruHead = entry->lruNext;
+    }
+
+    if (entry->lruNext != NULL) {
+        entry->lruNext->lruPrev = entry->lruPrev;
+    } else {
+        protoList->lruTail = entry->lruPrev;
+    }
+
+    entry->lruPrev = NULL;
+    entry->lruNext = NULL;
+}
+
+static void proto_list_lru_append(ProtoList* protoList, ProtoListEntry* entry)
+{
+    entry->lruPrev = protoList->lruTail;
+    entry->lruNext = NULL;
+
+    if (protoList->lruTail != NULL) {
+        protoList->lruTail->lruNext = entry;
+    } else {
+        protoList->lruHead = entry;
+    }
+
+    protoList->lruTail = entry;
+}
+
+// Removes entry from the cache list and frees it along with its proto.
+static void proto_list_remove(ProtoList* protoList, ProtoListEntry* entry)
+{
+    ProtoListEntry** link = proto_list_bucket(protoList, entry->pid);
+    while (entry->pid != -1 && *link != NULL) {
+        if (*link == entry) {
+            *link = entry->bucketNext;
+            break;
+        }
+        link = &((*link)->bucketNext);
+    }
+
+    proto_list_lru_remove(protoList, entry);
+    protoList->length--;
+
+    mem_free(entry->proto);
+    mem_free(entry);
+}
+
 // Clear all proto cache.
 //
 // 0x4A20F4
 void proto_remove_all()
 {
+    proto_dump_stats();
+
     for (int index = 0; index < 6; index++) {
         proto_remove_list(index);
     }
@@ -1797,28 +1864,49 @@ int proto_ptr(int pid, Proto** protoPtr)
         return 0;
     }
 
+    proto_stats_lookups++;
+
     ProtoList* protoList = &(protolists[PID_TYPE(pid)]);
-    ProtoListExtent* protoListExtent = protoList->head;
-    while (protoListExtent != NULL) {
-        for (int index = 0; index < protoListExtent->length; index++) {
-            Proto* proto = (Proto*)protoListExtent->proto[index];
-            if (pid == proto->pid) {
-                *protoPtr = proto;
-                return 0;
+    ProtoListEntry* entry = *proto_list_bucket(protoList, pid);
+    while (entry != NULL) {
+        if (pid == entry->proto->pid) {
+            if (entry != protoList->lruTail) {
+                proto_list_lru_remove(protoList, entry);
+                proto_list_lru_append(protoList, entry);
             }
+
+            *protoPtr = entry->proto;
+            return 0;
         }
-        protoListExtent = protoListExtent->next;
+        entry = entry->bucketNext;
     }
 
-    if (protoList->head != NULL && protoList->tail != NULL) {
-        if (PROTO_LIST_EXTENT_SIZE * protoList->length - (PROTO_LIST_EXTENT_SIZE - protoList->tail->length) > PROTO_LIST_MAX_ENTRIES) {
-            proto_remove_some_list(PID_TYPE(pid));
-        }
+    while (protoList->length >= PROTO_LIST_MAX_ENTRIES) {
+        proto_remove_some_list(PID_TYPE(pid));
     }
 
     return proto_load_pid(pid, protoPtr);
 }
 
+// Prints proto cache counters to debug output and resets them.
+void proto_dump_stats()
+{
+    int cached = 0;
+    for (int index = 0; index < 6; index++) {
+        cached += protolists[index].length;
+    }
+
+    debug_printf("\nproto cache: %llu lookups, %llu loads, %llu evictions, %d cached\n",
+        proto_stats_lookups,
+        proto_stats_loads,
+        proto_stats_evictions,
+        cached);
+
+    proto_stats_lookups = 0;
+    proto_stats_loads = 0;
+    proto_stats_evictions = 0;
+}
+
 // 0x4A21DC
 static int proto_new_id(int a1)
 {
@@ -141,6 +141,7 @@ int proto_load_pid(int pid, Proto** out_proto);
 int proto_find_free_subnode(int type, Proto** out_ptr);
 void proto_remove_all();
 int proto_ptr(int pid, Proto** out_proto);
+void proto_dump_stats();
 int proto_max_id(int a1);
 int ResetPlayer();
 
@@ -1,18 +1,19 @@
 #ifndef PROTO_TYPES_H
 #define PROTO_TYPES_H
 
-// Number of prototypes in prototype extent.
-#define PROTO_LIST_EXTENT_SIZE 16
-
 // Max number of prototypes of one type to be stored in prototype cache lists.
-// Once this value is reached the top most proto extent is removed from the
-// cache list.
+// Once this value is reached the least recently used proto is removed from
+// the cache list.
 //
 // See:
 // - [sub_4A2108]
 // - [sub_4A2040]
 #define PROTO_LIST_MAX_ENTRIES 512
 
+// The number of hash buckets in prototype cache list of one type. Must be a
+// power of two.
+#define PROTO_LIST_BUCKETS_LENGTH 512
+
 #define WEAPON_TWO_HAND 0x00000200
 
 enum {
@@ -465,18 +466,35 @@ typedef union Proto {
     MiscProto misc;
 } Proto;
 
-typedef struct ProtoListExtent {
-    Proto* proto[PROTO_LIST_EXTENT_SIZE];
-    // Number of protos in the extent
-    int length;
-    struct ProtoListExtent* next;
-} ProtoListExtent;
+typedef struct ProtoListEntry {
+    Proto* proto;
+
+    // The pid this entry is hashed by, -1 until it's inserted into hash
+    // table.
+    int pid;
+
+    // Next entry in the same hash bucket.
+    struct ProtoListEntry* bucketNext;
+
+    // Previous and next entries in the list ordered by last use (see
+    // [ProtoList.lruHead]).
+    struct ProtoListEntry* lruPrev;
+    struct ProtoListEntry* lruNext;
+} ProtoListEntry;
 
 typedef struct ProtoList {
-    ProtoListExtent* head;
-    ProtoListExtent* tail;
-    // Number of extents in the list.
+    // Hash table of cached protos keyed by pid. Entries in the same bucket
+    // are chained via `bucketNext`.
+    ProtoListEntry* buckets[PROTO_LIST_BUCKETS_LENGTH];
+
+    // Cached protos ordered from the least recently used (head) to the most
+    // recently used (tail).
+    ProtoListEntry* lruHead;
+    ProtoListEntry* lruTail;
+
+    // Number of protos in the list.
     int length;
+
     // Number of lines in proto/{type}/{type}.lst.
     int max_entries_num;
 } ProtoList;
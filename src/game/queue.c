@@ -1,5 +1,9 @@
 #include "game/queue.h"
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "game/actions.h"
 #include "game/critter.h"
 #include "game/display.h"
@@ -15,20 +19,61 @@
 #include "game/protinst.h"
 #include "game/scripts.h"
 
+// The number of buckets in owner index, must be a power of two.
+#define QUEUE_OWNER_BUCKETS_LENGTH 256
+
+// The number of nodes allocated at once when node pool is exhausted.
+#define QUEUE_NODE_POOL_CHUNK_LENGTH 64
+
+// The initial capacity of [queue_heap].
+#define QUEUE_HEAP_INITIAL_CAPACITY 64
+
 typedef struct QueueListNode {
     // TODO: Make unsigned.
     int time;
     int type;
     Object* owner;
     void* data;
+
+    // Order in which events were scheduled. Events scheduled for the same
+    // time are processed in this order.
+    unsigned int seq;
+
+    // Index of this node in [queue_heap], or -1 if node is not in queue.
+    int heapIndex;
+
+    // Previous and next nodes in the same owner bucket, ordered by time.
+    // `next` also links unused nodes in [queue_free_nodes].
+    struct QueueListNode* prev;
     struct QueueListNode* next;
 } QueueListNode;
 
+typedef struct QueueListNodeChunk {
+    struct QueueListNodeChunk* next;
+    QueueListNode nodes[QUEUE_NODE_POOL_CHUNK_LENGTH];
+} QueueListNodeChunk;
+
+typedef struct QueueSnapshotEntry {
+    QueueListNode* node;
+    unsigned int seq;
+} QueueSnapshotEntry;
+
 static int queue_destroy(Object* obj, void* data);
 static int queue_explode(Object* obj, void* data);
 static int queue_explode_exit(Object* obj, void* data);
 static int queue_do_explosion(Object* obj, bool a2);
 static int queue_premature(Object* obj, void* data);
+static QueueListNode* queue_node_acquire();
+static void queue_node_release(QueueListNode* node);
+static void queue_node_free(QueueListNode* node);
+static int queue_insert(QueueListNode* node);
+static void queue_unlink(QueueListNode* node);
+static bool queue_node_less(QueueListNode* a, QueueListNode* b);
+static void queue_heap_sift_up(int index);
+static void queue_heap_sift_down(int index);
+static QueueListNode** queue_owner_bucket(Object* owner);
+static QueueSnapshotEntry* queue_snapshot(int eventType, int* lengthPtr);
+static int queue_snapshot_compare(const void* a1, const void* a2);
 
 // Last queue list node found during [queue_find_first] and
 // [queue_find_next] calls.
@@ -36,8 +81,28 @@ static int queue_premature(Object* obj, void* data);
 // 0x51C690
 static QueueListNode* tmpQNode = NULL;
 
-// 0x6648C0
-static QueueListNode* queue;
+// Binary min-heap of scheduled events ordered by time and [seq].
+static QueueListNode** queue_heap = NULL;
+
+// The number of events in [queue_heap].
+static int queue_heap_length = 0;
+
+// The capacity of [queue_heap] array.
+static int queue_heap_capacity = 0;
+
+// Scheduled events hashed by owner. Events in each bucket are ordered by time
+// and [seq], so events of any owner can be visited in the order they will be
+// processed without touching events of other owners.
+static QueueListNode* queue_owner_buckets[QUEUE_OWNER_BUCKETS_LENGTH];
+
+// The [seq] of the next scheduled event.
+static unsigned int queue_next_seq = 0;
+
+// The list of unused nodes.
+static QueueListNode* queue_free_nodes = NULL;
+
+// The list of chunks backing all nodes.
+static QueueListNodeChunk* queue_node_chunks = NULL;
 
 // 0x51C540
 EventTypeDescription q_func[EVENT_TYPE_COUNT] = {
@@ -60,7 +125,13 @@ EventTypeDescription q_func[EVENT_TYPE_COUNT] = {
 // 0x4A2320
 void queue_init()
 {
-    queue = NULL;
+    queue_heap = NULL;
+    queue_heap_length = 0;
+    queue_heap_capacity = 0;
+    memset(queue_owner_buckets, 0, sizeof(queue_owner_buckets));
+    queue_next_seq = 0;
+    queue_free_nodes = NULL;
+    queue_node_chunks = NULL;
 }
 
 // NOTE: Uncollapsed 0x4A2330.
@@ -78,6 +149,20 @@ int queue_reset()
 int queue_exit()
 {
     queue_clear();
+
+    while (queue_node_chunks != NULL) {
+        QueueListNodeChunk* next = queue_node_chunks->next;
+        mem_free(queue_node_chunks);
+        queue_node_chunks = next;
+    }
+    queue_free_nodes = NULL;
+
+    if (queue_heap != NULL) {
+        mem_free(queue_heap);
+        queue_heap = NULL;
+    }
+    queue_heap_capacity = 0;
+
     return 0;
 }
 
@@ -89,34 +174,41 @@ int queue_load(File* stream)
         return -1;
     }
 
-    QueueListNode* oldListHead = queue;
-    queue = NULL;
+    // Take out events which are already scheduled, they are merged back
+    // after loaded events with the same time.
+    int oldNodesLength;
+    QueueSnapshotEntry* oldNodes = queue_snapshot(-1, &oldNodesLength);
+    if (oldNodes == NULL && oldNodesLength != 0) {
+        return -1;
+    }
 
-    QueueListNode** nextPtr = &queue;
+    for (int index = 0; index < oldNodesLength; index++) {
+        queue_unlink(oldNodes[index].node);
+    }
 
     int rc = 0;
     for (int index = 0; index < count; index += 1) {
-        QueueListNode* queueListNode = (QueueListNode*)mem_malloc(sizeof(*queueListNode));
+        QueueListNode* queueListNode = queue_node_acquire();
         if (queueListNode == NULL) {
             rc = -1;
             break;
         }
 
         if (db_freadInt(stream, &(queueListNode->time)) == -1) {
-            mem_free(queueListNode);
+            queue_node_release(queueListNode);
             rc = -1;
             break;
         }
 
         if (db_freadInt(stream, &(queueListNode->type)) == -1) {
-            mem_free(queueListNode);
+            queue_node_release(queueListNode);
             rc = -1;
             break;
         }
 
         int objectId;
         if (db_freadInt(stream, &objectId) == -1) {
-            mem_free(queueListNode);
+            queue_node_release(queueListNode);
             rc = -1;
             break;
         }
@@ -140,7 +232,7 @@ int queue_load(File* stream)
         EventTypeDescription* eventTypeDescription = &(q_func[queueListNode->type]);
         if (eventTypeDescription->readProc != NULL) {
             if (eventTypeDescription->readProc(stream, &(queueListNode->data)) == -1) {
-                mem_free(queueListNode);
+                queue_node_release(queueListNode);
                 rc = -1;
                 break;
             }
@@ -148,48 +240,29 @@ int queue_load(File* stream)
             queueListNode->data = NULL;
         }
 
-        queueListNode->next = NULL;
+        queueListNode->seq = queue_next_seq++;
 
-        *nextPtr = queueListNode;
-        nextPtr = &(queueListNode->next);
+        if (queue_insert(queueListNode) == -1) {
+            queue_node_free(queueListNode);
+            rc = -1;
+            break;
+        }
     }
 
     if (rc == -1) {
-        while (queue != NULL) {
-            QueueListNode* next = queue->next;
-
-            EventTypeDescription* eventTypeDescription = &(q_func[queue->type]);
-            if (eventTypeDescription->freeProc != NULL) {
-                eventTypeDescription->freeProc(queue->data);
-            }
-
-            mem_free(queue);
+        queue_clear();
+    }
 
-            queue = next;
+    for (int index = 0; index < oldNodesLength; index++) {
+        QueueListNode* node = oldNodes[index].node;
+        node->seq = queue_next_seq++;
+        if (queue_insert(node) == -1) {
+            queue_node_free(node);
         }
     }
 
-    if (oldListHead != NULL) {
-        QueueListNode** v13 = &queue;
-        QueueListNode* v15;
-        do {
-            while (true) {
-                QueueListNode* v14 = *v13;
-                if (v14 == NULL) {
-                    break;
-                }
-
-                if (v14->time > oldListHead->time) {
-                    break;
-                }
-
-                v13 = &(v14->next);
-            }
-            v15 = oldListHead->next;
-            oldListHead->next = *v13;
-            *v13 = oldListHead;
-            oldListHead = v15;
-        } while (v15 != NULL);
+    if (oldNodes != NULL) {
+        mem_free(oldNodes);
     }
 
     return rc;
@@ -198,54 +271,57 @@ int queue_load(File* stream)
 // 0x4A24E0
 int queue_save(File* stream)
 {
-    QueueListNode* queueListNode;
-
-    int count = 0;
-
-    queueListNode = queue;
-    while (queueListNode != NULL) {
-        count += 1;
-        queueListNode = queueListNode->next;
+    int count;
+    QueueSnapshotEntry* entries = queue_snapshot(-1, &count);
+    if (entries == NULL && count != 0) {
+        return -1;
     }
 
+    int rc = 0;
     if (db_fwriteInt(stream, count) == -1) {
-        return -1;
+        rc = -1;
     }
 
-    queueListNode = queue;
-    while (queueListNode != NULL) {
+    for (int index = 0; index < count && rc == 0; index++) {
+        QueueListNode* queueListNode = entries[index].node;
         Object* object = queueListNode->owner;
         int objectId = object != NULL ? object->id : -2;
 
         if (db_fwriteInt(stream, queueListNode->time) == -1) {
-            return -1;
+            rc = -1;
+            break;
         }
 
         if (db_fwriteInt(stream, queueListNode->type) == -1) {
-            return -1;
+            rc = -1;
+            break;
         }
 
         if (db_fwriteInt(stream, objectId) == -1) {
-            return -1;
+            rc = -1;
+            break;
         }
 
         EventTypeDescription* eventTypeDescription = &(q_func[queueListNode->type]);
         if (eventTypeDescription->writeProc != NULL) {
             if (eventTypeDescription->writeProc(stream, queueListNode->data) == -1) {
-                return -1;
+                rc = -1;
+                break;
             }
         }
+    }
 
-        queueListNode = queueListNode->next;
+    if (entries != NULL) {
+        mem_free(entries);
     }
 
-    return 0;
+    return rc;
 }
 
 // 0x4A258C
 int queue_add(int delay, Object* obj, void* data, int eventType)
 {
-    QueueListNode* newQueueListNode = (QueueListNode*)mem_malloc(sizeof(QueueListNode));
+    QueueListNode* newQueueListNode = queue_node_acquire();
     if (newQueueListNode == NULL) {
         return -1;
     }
@@ -256,54 +332,33 @@ int queue_add(int delay, Object* obj, void* data, int eventType)
     newQueueListNode->type = eventType;
     newQueueListNode->owner = obj;
     newQueueListNode->data = data;
+    newQueueListNode->seq = queue_next_seq++;
 
-    if (obj != NULL) {
-        obj->flags |= OBJECT_USED;
+    if (queue_insert(newQueueListNode) == -1) {
+        queue_node_release(newQueueListNode);
+        return -1;
     }
 
-    QueueListNode** v3 = &queue;
-
-    if (queue != NULL) {
-        QueueListNode* v4;
-
-        do {
-            v4 = *v3;
-            if (v2 < v4->time) {
-                break;
-            }
-            v3 = &(v4->next);
-        } while (v4->next != NULL);
+    if (obj != NULL) {
+        obj->flags |= OBJECT_USED;
     }
 
-    newQueueListNode->next = *v3;
-    *v3 = newQueueListNode;
-
     return 0;
 }
 
 // 0x4A25F4
 int queue_remove(Object* owner)
 {
-    QueueListNode* queueListNode = queue;
-    QueueListNode** queueListNodePtr = &queue;
+    QueueListNode* queueListNode = *queue_owner_bucket(owner);
+    while (queueListNode != NULL) {
+        QueueListNode* next = queueListNode->next;
 
-    while (queueListNode) {
         if (queueListNode->owner == owner) {
-            QueueListNode* temp = queueListNode;
-
-            queueListNode = queueListNode->next;
-            *queueListNodePtr = queueListNode;
-
-            EventTypeDescription* eventTypeDescription = &(q_func[temp->type]);
-            if (eventTypeDescription->freeProc != NULL) {
-                eventTypeDescription->freeProc(temp->data);
-            }
-
-            mem_free(temp);
-        } else {
-            queueListNodePtr = &(queueListNode->next);
-            queueListNode = queueListNode->next;
+            queue_unlink(queueListNode);
+            queue_node_free(queueListNode);
         }
+
+        queueListNode = next;
     }
 
     return 0;
@@ -312,26 +367,16 @@ int queue_remove(Object* owner)
 // 0x4A264C
 int queue_remove_this(Object* owner, int eventType)
 {
-    QueueListNode* queueListNode = queue;
-    QueueListNode** queueListNodePtr = &queue;
+    QueueListNode* queueListNode = *queue_owner_bucket(owner);
+    while (queueListNode != NULL) {
+        QueueListNode* next = queueListNode->next;
 
-    while (queueListNode) {
         if (queueListNode->owner == owner && queueListNode->type == eventType) {
-            QueueListNode* temp = queueListNode;
-
-            queueListNode = queueListNode->next;
-            *queueListNodePtr = queueListNode;
-
-            EventTypeDescription* eventTypeDescription = &(q_func[temp->type]);
-            if (eventTypeDescription->freeProc != NULL) {
-                eventTypeDescription->freeProc(temp->data);
-            }
-
-            mem_free(temp);
-        } else {
-            queueListNodePtr = &(queueListNode->next);
-            queueListNode = queueListNode->next;
+            queue_unlink(queueListNode);
+            queue_node_free(queueListNode);
         }
+
+        queueListNode = next;
     }
 
     return 0;
@@ -342,7 +387,7 @@ int queue_remove_this(Object* owner, int eventType)
 // 0x4A26A8
 bool queue_find(Object* owner, int eventType)
 {
-    QueueListNode* queueListEvent = queue;
+    QueueListNode* queueListEvent = *queue_owner_bucket(owner);
     while (queueListEvent != NULL) {
         if (owner == queueListEvent->owner && eventType == queueListEvent->type) {
             return true;
@@ -360,22 +405,18 @@ int queue_process()
     int time = game_time();
     int v1 = 0;
 
-    while (queue != NULL) {
-        QueueListNode* queueListNode = queue;
+    while (queue_heap_length != 0) {
+        QueueListNode* queueListNode = queue_heap[0];
         if (time < queueListNode->time || v1 != 0) {
             break;
         }
 
-        queue = queueListNode->next;
+        queue_unlink(queueListNode);
 
         EventTypeDescription* eventTypeDescription = &(q_func[queueListNode->type]);
         v1 = eventTypeDescription->handlerProc(queueListNode->owner, queueListNode->data);
 
-        if (eventTypeDescription->freeProc != NULL) {
-            eventTypeDescription->freeProc(queueListNode->data);
-        }
-
-        mem_free(queueListNode);
+        queue_node_free(queueListNode);
     }
 
     return v1;
@@ -384,52 +425,49 @@ int queue_process()
 // 0x4A2748
 void queue_clear()
 {
-    QueueListNode* queueListNode = queue;
-    while (queueListNode != NULL) {
-        QueueListNode* next = queueListNode->next;
-
-        EventTypeDescription* eventTypeDescription = &(q_func[queueListNode->type]);
-        if (eventTypeDescription->freeProc != NULL) {
-            eventTypeDescription->freeProc(queueListNode->data);
-        }
-
-        mem_free(queueListNode);
-
-        queueListNode = next;
+    while (queue_heap_length != 0) {
+        QueueListNode* queueListNode = queue_heap[queue_heap_length - 1];
+        queue_unlink(queueListNode);
+        queue_node_free(queueListNode);
     }
-
-    queue = NULL;
 }
 
+// NOTE: Events scheduled by [fn] itself are not visited. The original list
+// walk visited some of them depending on where they landed relative to the
+// current position, which could make explosives rescheduling themselves on
+// every visit loop for a long time.
+//
 // 0x4A2790
 void queue_clear_type(int eventType, QueueEventHandler* fn)
 {
-    QueueListNode** ptr = &queue;
-    QueueListNode* curr = *ptr;
+    int length;
+    QueueSnapshotEntry* entries = queue_snapshot(eventType, &length);
+    if (entries == NULL) {
+        return;
+    }
 
-    while (curr != NULL) {
-        if (eventType == curr->type) {
-            QueueListNode* tmp = curr;
+    for (int index = 0; index < length; index++) {
+        QueueListNode* tmp = entries[index].node;
 
-            *ptr = curr->next;
-            curr = *ptr;
+        // Skip events removed (and possibly reused for another event) by one
+        // of the previous [fn] calls.
+        if (tmp->heapIndex == -1 || tmp->seq != entries[index].seq) {
+            continue;
+        }
 
-            if (fn != NULL && fn(tmp->owner, tmp->data) != 1) {
-                *ptr = tmp;
-                ptr = &(tmp->next);
-            } else {
-                EventTypeDescription* eventTypeDescription = &(q_func[tmp->type]);
-                if (eventTypeDescription->freeProc != NULL) {
-                    eventTypeDescription->freeProc(tmp->data);
-                }
+        queue_unlink(tmp);
 
-                mem_free(tmp);
+        if (fn != NULL && fn(tmp->owner, tmp->data) != 1) {
+            // Put it back to the same place, time and seq are unchanged.
+            if (queue_insert(tmp) == -1) {
+                queue_node_free(tmp);
             }
         } else {
-            ptr = &(curr->next);
-            curr = *ptr;
+            queue_node_free(tmp);
         }
     }
+
+    mem_free(entries);
 }
 
 // TODO: Make unsigned.
@@ -437,11 +475,11 @@ void queue_clear_type(int eventType, QueueEventHandler* fn)
 // 0x4A2808
 int queue_next_time()
 {
-    if (queue == NULL) {
+    if (queue_heap_length == 0) {
         return 0;
     }
 
-    return queue->time;
+    return queue_heap[0]->time;
 }
 
 // 0x4A281C
@@ -536,13 +574,13 @@ void queue_leaving_map()
 // 0x4A294C
 bool queue_is_empty()
 {
-    return queue == NULL;
+    return queue_heap_length == 0;
 }
 
 // 0x4A295C
 void* queue_find_first(Object* owner, int eventType)
 {
-    QueueListNode* queueListNode = queue;
+    QueueListNode* queueListNode = *queue_owner_bucket(owner);
     while (queueListNode != NULL) {
         if (owner == queueListNode->owner && eventType == queueListNode->type) {
             tmpQNode = queueListNode;
@@ -573,3 +611,239 @@ void* queue_find_next(Object* owner, int eventType)
 
     return NULL;
 }
+
+// Takes unused node from the pool, allocating another chunk of nodes if
+// needed.
+static QueueListNode* queue_node_acquire()
+{
+    if (queue_free_nodes == NULL) {
+        QueueListNodeChunk* chunk = (QueueListNodeChunk*)mem_malloc(sizeof(*chunk));
+        if (chunk == NULL) {
+            return NULL;
+        }
+
+        chunk->next = queue_node_chunks;
+        queue_node_chunks = chunk;
+
+        for (int index = 0; index < QUEUE_NODE_POOL_CHUNK_LENGTH; index++) {
+            queue_node_release(&(chunk->nodes[index]));
+        }
+    }
+
+    QueueListNode* node = queue_free_nodes;
+    queue_free_nodes = node->next;
+
+    node->next = NULL;
+    node->prev = NULL;
+    node->heapIndex = -1;
+
+    return node;
+}
+
+// Returns node to the pool.
+static void queue_node_release(QueueListNode* node)
+{
+    // Make sure stale [tmpQNode] never matches anything.
+    node->type = -1;
+    node->owner = NULL;
+    node->data = NULL;
+    node->heapIndex = -1;
+    node->prev = NULL;
+    node->next = queue_free_nodes;
+    queue_free_nodes = node;
+}
+
+// Frees event data and returns node to the pool.
+static void queue_node_free(QueueListNode* node)
+{
+    EventTypeDescription* eventTypeDescription = &(q_func[node->type]);
+    if (eventTypeDescription->freeProc != NULL) {
+        eventTypeDescription->freeProc(node->data);
+    }
+
+    queue_node_release(node);
+}
+
+// Adds node to the heap and to it's owner bucket. The node's time and seq
+// must be set.
+static int queue_insert(QueueListNode* node)
+{
+    if (queue_heap_length == queue_heap_capacity) {
+        int capacity = queue_heap_capacity != 0 ? queue_heap_capacity * 2 : QUEUE_HEAP_INITIAL_CAPACITY;
+        QueueListNode** heap = (QueueListNode**)mem_realloc(queue_heap, sizeof(*heap) * capacity);
+        if (heap == NULL) {
+            return -1;
+        }
+
+        queue_heap = heap;
+        queue_heap_capacity = capacity;
+    }
+
+    node->heapIndex = queue_heap_length;
+    queue_heap[queue_heap_length++] = node;
+    queue_heap_sift_up(node->heapIndex);
+
+    QueueListNode** bucket = queue_owner_bucket(node->owner);
+    QueueListNode* prev = NULL;
+    QueueListNode* curr = *bucket;
+    while (curr != NULL && !queue_node_less(node, curr)) {
+        prev = curr;
+        curr = curr->next;
+    }
+
+    node->prev = prev;
+    node->next = curr;
+
+    if (prev != NULL) {
+        prev->next = node;
+    } else {
+        *bucket = node;
+    }
+
+    if (curr != NULL) {
+        curr->prev = node;
+    }
+
+    return 0;
+}
+
+// Removes node from the heap and from it's owner bucket.
+static void queue_unlink(QueueListNode* node)
+{
+    int index = node->heapIndex;
+    queue_heap_length--;
+    if (index != queue_heap_length) {
+        queue_heap[index] = queue_heap[queue_heap_length];
+        queue_heap[index]->heapIndex = index;
+        queue_heap_sift_up(index);
+        queue_heap_sift_down(queue_heap[index]->heapIndex);
+    }
+    node->heapIndex = -1;
+
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        *queue_owner_bucket(node->owner) = node->next;
+    }
+
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    }
+
+    node->prev = NULL;
+    node->next = NULL;
+}
+
+static bool queue_node_less(QueueListNode* a, QueueListNode* b)
+{
+    if (a->time != b->time) {
+        return a->time < b->time;
+    }
+
+    return (int)(a->seq - b->seq) < 0;
+}
+
+static void queue_heap_sift_up(int index)
+{
+    QueueListNode* node = queue_heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!queue_node_less(node, queue_heap[parent])) {
+            break;
+        }
+
+        queue_heap[index] = queue_heap[parent];
+        queue_heap[index]->heapIndex = index;
+        index = parent;
+    }
+
+    queue_heap[index] = node;
+    node->heapIndex = index;
+}
+
+static void queue_heap_sift_down(int index)
+{
+    QueueListNode* node = queue_heap[index];
+    while (1) {
+        int next = index * 2 + 1;
+        if (next >= queue_heap_length) {
+            break;
+        }
+
+        if (next + 1 < queue_heap_length && queue_node_less(queue_heap[next + 1], queue_heap[next])) {
+            next += 1;
+        }
+
+        if (!queue_node_less(queue_heap[next], node)) {
+            break;
+        }
+
+        queue_heap[index] = queue_heap[next];
+        queue_heap[index]->heapIndex = index;
+        index = next;
+    }
+
+    queue_heap[index] = node;
+    node->heapIndex = index;
+}
+
+static QueueListNode** queue_owner_bucket(Object* owner)
+{
+    unsigned int hash = (unsigned int)((uintptr_t)owner >> 3) * 2654435769U;
+    return &(queue_owner_buckets[(hash >> 16) & (QUEUE_OWNER_BUCKETS_LENGTH - 1)]);
+}
+
+// Returns array of scheduled events of given type (or all events if type is
+// -1) in the order they will be processed. The caller is responsible for
+// freeing the array with [mem_free]. Returns NULL if there are no such events
+// or array cannot be allocated.
+static QueueSnapshotEntry* queue_snapshot(int eventType, int* lengthPtr)
+{
+    int length = 0;
+    for (int index = 0; index < queue_heap_length; index++) {
+        if (eventType == -1 || queue_heap[index]->type == eventType) {
+            length++;
+        }
+    }
+
+    *lengthPtr = length;
+
+    if (length == 0) {
+        return NULL;
+    }
+
+    QueueSnapshotEntry* entries = (QueueSnapshotEntry*)mem_malloc(sizeof(*entries) * length);
+    if (entries == NULL) {
+        return NULL;
+    }
+
+    length = 0;
+    for (int index = 0; index < queue_heap_length; index++) {
+        QueueListNode* node = queue_heap[index];
+        if (eventType == -1 || node->type == eventType) {
+            entries[length].node = node;
+            entries[length].seq = node->seq;
+            length++;
+        }
+    }
+
+    qsort(entries, length, sizeof(*entries), queue_snapshot_compare);
+
+    return entries;
+}
+
+static int queue_snapshot_compare(const void* a1, const void* a2)
+{
+    QueueListNode* v1 = ((QueueSnapshotEntry*)a1)->node;
+    QueueListNode* v2 = ((QueueSnapshotEntry*)a2)->node;
+
+    if (queue_node_less(v1, v2)) {
+        return -1;
+    }
+
+    if (queue_node_less(v2, v1)) {
+        return 1;
+    }
+
+    return 0;
+}
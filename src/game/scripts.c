@@ -20,6 +20,7 @@
 #include "game/gdialog.h"
 #include "game/gmouse.h"
 #include "game/gmovie.h"
+#include "game/map_defs.h"
 #include "plib/gnw/memory.h"
 #include "game/object.h"
 #include "game/proto.h"
@@ -32,6 +33,21 @@
 
 #define SCRIPT_LIST_EXTENT_SIZE 16
 
+// Size (in hexes) of square cells of spatial scripts index (see
+// [scr_spatial_cells]).
+#define SPATIAL_CELL_SIZE 8
+
+#define SPATIAL_GRID_WIDTH ((HEX_GRID_WIDTH + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE)
+#define SPATIAL_GRID_HEIGHT ((HEX_GRID_HEIGHT + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE)
+#define SPATIAL_GRID_SIZE (SPATIAL_GRID_WIDTH * SPATIAL_GRID_HEIGHT)
+
+// Maximum number of script ids per script type tracked by [scr_index].
+// Scripts with larger ids (which [scr_new_id] never assigns) are looked up
+// with linear scan.
+#define SCRIPT_INDEX_CAPACITY_MAX 32768
+
+#define SID_INDEX(sid) ((sid)&0xFFFFFF)
+
 typedef struct ScriptListExtent {
     Script scripts[SCRIPT_LIST_EXTENT_SIZE];
     // Number of scripts in the extent
@@ -51,6 +67,26 @@ typedef struct ScriptList {
 
 static_assert(sizeof(ScriptList) == 0x10, "wrong size");
 
+// A cell of spatial scripts index. Contains sids of spatial scripts which
+// can be triggered from any hex within the cell, in the order of spatial
+// scripts list.
+typedef struct SpatialCell {
+    int* sids;
+    int length;
+    int capacity;
+} SpatialCell;
+
+// Direct-indexed table of scripts of one type keyed by [SID_INDEX].
+typedef struct ScriptIndex {
+    Script** scripts;
+    int capacity;
+
+    // Set when the index is not in sync with the script list (out of memory
+    // or failed [scr_load]), lookups fall back to linear scan until the
+    // index is rebuilt.
+    bool incomplete;
+} ScriptIndex;
+
 typedef struct ScriptState {
     unsigned int requests;
     STRUCT_664980 combatState1;
@@ -82,6 +118,12 @@ static int scr_read_ScriptSubNode(Script* scr, File* stream);
 static int scr_read_ScriptNode(ScriptListExtent* a1, File* stream);
 static int scr_new_id(int scriptType);
 static void scrExecMapProcScripts(int a1);
+static int scr_spatial_cell_add(SpatialCell* cell, int sid);
+static void scr_spatial_index_build();
+static void scr_spatial_index_free();
+static void scr_index_set(int sid, Script* script);
+static void scr_index_rebuild(int scriptType);
+static void scr_index_free();
 
 // Number of lines in scripts.lst
 //
@@ -103,6 +145,22 @@ static bool scrSpatialsEnabled = true;
 // 0x51C6C0
 static ScriptList scriptlists[SCRIPT_TYPE_COUNT];
 
+// Spatial scripts bucketed by the cells their trigger area overlaps.
+static SpatialCell scr_spatial_cells[ELEVATION_COUNT][SPATIAL_GRID_SIZE];
+
+// Set when spatial scripts list has changed and [scr_spatial_cells] needs to
+// be rebuilt.
+static bool scr_spatial_index_dirty = true;
+
+// Sids of spatial scripts to be checked by [scr_chk_spatials_in]. Scripts can
+// be added or removed while spatial procs are being executed, so the cell is
+// copied before executing them.
+static int* scr_spatial_candidates = NULL;
+static int scr_spatial_candidates_capacity = 0;
+
+// Locations of scripts by their sids, see [scr_ptr].
+static ScriptIndex scr_index[SCRIPT_TYPE_COUNT];
+
 // 0x51C710
 static char script_path_base[] = "scripts\\";
 
@@ -1542,6 +1600,8 @@ int scr_exit()
 
     scr_remove_all();
     scr_remove_all_force();
+    scr_spatial_index_free();
+    scr_index_free();
     interpretClose();
     clearPrograms();
 
@@ -1812,6 +1872,10 @@ int scr_save(File* stream)
                         memcpy(script, &(lastScriptExtent->scripts[backwardsIndex]), sizeof(Script));
                         memcpy(&(lastScriptExtent->scripts[backwardsIndex]), &temp, sizeof(Script));
 
+                        // Both scripts moved, keep [scr_index] in sync.
+                        scr_index_set(script->sid, script);
+                        scr_index_set(temp.sid, &(lastScriptExtent->scripts[backwardsIndex]));
+
                         scriptCount++;
                     }
                 }
@@ -1930,6 +1994,12 @@ static int scr_read_ScriptNode(ScriptListExtent* scriptExtent, File* stream)
 // 0x4A5C50
 int scr_load(File* stream)
 {
+    scr_spatial_index_dirty = true;
+
+    for (int index = 0; index < SCRIPT_TYPE_COUNT; index++) {
+        scr_index[index].incomplete = true;
+    }
+
     for (int index = 0; index < SCRIPT_TYPE_COUNT; index++) {
         ScriptList* scriptList = &(scriptlists[index]);
 
@@ -1999,6 +2069,8 @@ int scr_load(File* stream)
             scriptList->tail = NULL;
             scriptList->length = 0;
         }
+
+        scr_index_rebuild(index);
     }
 
     return 0;
@@ -2019,6 +2091,26 @@ int scr_ptr(int sid, Script** scriptPtr)
         return -1;
     }
 
+    ScriptIndex* scriptIndex = &(scr_index[SID_TYPE(sid)]);
+    if (SID_INDEX(sid) < SCRIPT_INDEX_CAPACITY_MAX && !scriptIndex->incomplete) {
+        // Index is authoritative for this range of ids.
+        if (SID_INDEX(sid) >= scriptIndex->capacity) {
+            return -1;
+        }
+
+        Script* script = scriptIndex->scripts[SID_INDEX(sid)];
+        if (script == NULL) {
+            return -1;
+        }
+
+        if (script->sid == sid) {
+            *scriptPtr = script;
+            return 0;
+        }
+
+        debug_printf("\nERROR: scr_ptr: script index is out of sync!");
+    }
+
     ScriptList* scriptList = &(scriptlists[SID_TYPE(sid)]);
     ScriptListExtent* scriptListExtent = scriptList->head;
 
@@ -2036,6 +2128,80 @@ int scr_ptr(int sid, Script** scriptPtr)
     return -1;
 }
 
+// Sets location of the script with given sid in [scr_index], `NULL` removes
+// it from the index.
+static void scr_index_set(int sid, Script* script)
+{
+    int index = SID_INDEX(sid);
+    if (index >= SCRIPT_INDEX_CAPACITY_MAX) {
+        return;
+    }
+
+    ScriptIndex* scriptIndex = &(scr_index[SID_TYPE(sid)]);
+    if (index >= scriptIndex->capacity) {
+        if (script == NULL) {
+            return;
+        }
+
+        int capacity = scriptIndex->capacity != 0 ? scriptIndex->capacity : 256;
+        while (capacity <= index) {
+            capacity *= 2;
+        }
+
+        Script** scripts = (Script**)mem_realloc(scriptIndex->scripts, sizeof(*scripts) * capacity);
+        if (scripts == NULL) {
+            debug_printf("\nError in mem_realloc in scr_index_set!\n");
+            scriptIndex->incomplete = true;
+            return;
+        }
+
+        memset(scripts + scriptIndex->capacity, 0, sizeof(*scripts) * (capacity - scriptIndex->capacity));
+
+        scriptIndex->scripts = scripts;
+        scriptIndex->capacity = capacity;
+    }
+
+    scriptIndex->scripts[index] = script;
+}
+
+// Rebuilds [scr_index] for given script type from the script list.
+static void scr_index_rebuild(int scriptType)
+{
+    ScriptIndex* scriptIndex = &(scr_index[scriptType]);
+    if (scriptIndex->scripts != NULL) {
+        memset(scriptIndex->scripts, 0, sizeof(*scriptIndex->scripts) * scriptIndex->capacity);
+    }
+
+    scriptIndex->incomplete = false;
+
+    ScriptListExtent* extent = scriptlists[scriptType].head;
+    while (extent != NULL) {
+        for (int index = 0; index < extent->length; index++) {
+            Script* script = &(extent->scripts[index]);
+
+            // In case of duplicate sids linear scan finds the first one.
+            Script* existing;
+            if (scr_ptr(script->sid, &existing) == -1) {
+                scr_index_set(script->sid, script);
+            }
+        }
+        extent = extent->next;
+    }
+}
+
+static void scr_index_free()
+{
+    for (int scriptType = 0; scriptType < SCRIPT_TYPE_COUNT; scriptType++) {
+        ScriptIndex* scriptIndex = &(scr_index[scriptType]);
+        if (scriptIndex->scripts != NULL) {
+            mem_free(scriptIndex->scripts);
+            scriptIndex->scripts = NULL;
+        }
+        scriptIndex->capacity = 0;
+        scriptIndex->incomplete = false;
+    }
+}
+
 // 0x4A5ED8
 static int scr_new_id(int scriptType)
 {
@@ -2093,6 +2259,12 @@ int scr_new(int* sidPtr, int scriptType)
 
     *sidPtr = sid;
 
+    if (scriptType == SCRIPT_TYPE_SPATIAL) {
+        // Location of new spatial script is set by the caller, the index is
+        // rebuilt on the next [scr_chk_spatials_in].
+        scr_spatial_index_dirty = true;
+    }
+
     Script* scr = &(scriptListExtent->scripts[scriptListExtent->length]);
     scr->sid = sid;
     scr->sp.built_tile = -1;
@@ -2120,6 +2292,8 @@ int scr_new(int* sidPtr, int scriptType)
 
     scriptListExtent->length++;
 
+    scr_index_set(sid, scr);
+
     return 0;
 }
 
@@ -2205,6 +2379,10 @@ int scr_remove(int sid)
     }
 
     if ((script->flags & SCRIPT_FLAG_0x10) == 0) {
+        if (SID_TYPE(sid) == SCRIPT_TYPE_SPATIAL) {
+            scr_spatial_index_dirty = true;
+        }
+
         // NOTE: Uninline.
         scripts_clear_combat_requests(script);
 
@@ -2216,6 +2394,8 @@ int scr_remove(int sid)
             debug_printf("\nERROR Removing Timed Events on scr_remove!!\n");
         }
 
+        scr_index_set(sid, NULL);
+
         if (scriptListExtent == scriptList->tail && index + 1 == scriptListExtent->length) {
             // Removing last script in tail extent
             scriptListExtent->length -= 1;
@@ -2239,6 +2419,7 @@ int scr_remove(int sid)
         } else {
             // Relocate last script from tail extent into this script's slot.
             memcpy(&(scriptListExtent->scripts[index]), &(scriptList->tail->scripts[scriptList->tail->length - 1]), sizeof(Script));
+            scr_index_set(scriptListExtent->scripts[index].sid, &(scriptListExtent->scripts[index]));
 
             // Decrement number of scripts in tail extent.
             scriptList->tail->length -= 1;
@@ -2328,8 +2509,12 @@ int scr_remove_all_force()
         scriptList->head = NULL;
         scriptList->tail = NULL;
         scriptList->length = 0;
+
+        scr_index_rebuild(type);
     }
 
+    scr_spatial_index_dirty = true;
+
     scr_find_first_idx = 0;
     scr_find_first_ptr = 0;
     scr_find_first_elev = 0;
@@ -2441,7 +2626,40 @@ bool scr_chk_spatials_in(Object* object, int tile, int elevation)
 
     int builtTile = builtTileCreate(tile, elevation);
 
-    for (Script* script = scr_find_first_at(elevation); script != NULL; script = scr_find_next_at()) {
+    if (scr_spatial_index_dirty) {
+        scr_spatial_index_build();
+    }
+
+    int candidatesLength = 0;
+    if (elevation >= 0 && elevation < ELEVATION_COUNT && tile < HEX_GRID_SIZE) {
+        int cellX = (tile % HEX_GRID_WIDTH) / SPATIAL_CELL_SIZE;
+        int cellY = (tile / HEX_GRID_WIDTH) / SPATIAL_CELL_SIZE;
+        SpatialCell* cell = &(scr_spatial_cells[elevation][cellY * SPATIAL_GRID_WIDTH + cellX]);
+
+        if (cell->length > scr_spatial_candidates_capacity) {
+            int* candidates = (int*)mem_realloc(scr_spatial_candidates, sizeof(*candidates) * cell->length);
+            if (candidates != NULL) {
+                scr_spatial_candidates = candidates;
+                scr_spatial_candidates_capacity = cell->length;
+            }
+        }
+
+        if (cell->length <= scr_spatial_candidates_capacity) {
+            candidatesLength = cell->length;
+            memcpy(scr_spatial_candidates, cell->sids, sizeof(*scr_spatial_candidates) * candidatesLength);
+        }
+    }
+
+    for (int index = 0; index < candidatesLength; index++) {
+        Script* script;
+        if (scr_ptr(scr_spatial_candidates[index], &script) == -1) {
+            continue;
+        }
+
+        if ((script->flags & SCRIPT_FLAG_0x02) != 0 || builtTileGetElevation(script->sp.built_tile) != elevation) {
+            continue;
+        }
+
         if (builtTile == script->sp.built_tile) {
             // NOTE: Uninline.
             scr_set_objs(script->sid, object, NULL);
@@ -2467,6 +2685,96 @@ bool scr_chk_spatials_in(Object* object, int tile, int elevation)
     return true;
 }
 
+// Appends sid to the spatial index cell.
+static int scr_spatial_cell_add(SpatialCell* cell, int sid)
+{
+    if (cell->length == cell->capacity) {
+        int capacity = cell->capacity != 0 ? cell->capacity * 2 : 4;
+        int* sids = (int*)mem_realloc(cell->sids, sizeof(*sids) * capacity);
+        if (sids == NULL) {
+            return -1;
+        }
+
+        cell->sids = sids;
+        cell->capacity = capacity;
+    }
+
+    cell->sids[cell->length++] = sid;
+
+    return 0;
+}
+
+// Rebuilds [scr_spatial_cells] from the spatial scripts list.
+//
+// Every step between adjacent hexes changes both hex column and row by at
+// most one, so hexes within `radius` of the script's tile are contained in
+// the square of `radius` hexes around it. The script is added to every cell
+// this square overlaps.
+static void scr_spatial_index_build()
+{
+    for (int elevation = 0; elevation < ELEVATION_COUNT; elevation++) {
+        for (int index = 0; index < SPATIAL_GRID_SIZE; index++) {
+            scr_spatial_cells[elevation][index].length = 0;
+        }
+    }
+
+    ScriptListExtent* extent = scriptlists[SCRIPT_TYPE_SPATIAL].head;
+    while (extent != NULL) {
+        for (int scriptIndex = 0; scriptIndex < extent->length; scriptIndex++) {
+            Script* script = &(extent->scripts[scriptIndex]);
+
+            int elevation = builtTileGetElevation(script->sp.built_tile);
+            int tile = builtTileGetTile(script->sp.built_tile);
+            if (elevation < 0 || elevation >= ELEVATION_COUNT || tile < 0 || tile >= HEX_GRID_SIZE) {
+                continue;
+            }
+
+            int radius = script->sp.radius > 0 ? script->sp.radius : 0;
+            int x = tile % HEX_GRID_WIDTH;
+            int y = tile / HEX_GRID_WIDTH;
+
+            int minCellX = (x - radius > 0 ? x - radius : 0) / SPATIAL_CELL_SIZE;
+            int maxCellX = (x + radius < HEX_GRID_WIDTH - 1 ? x + radius : HEX_GRID_WIDTH - 1) / SPATIAL_CELL_SIZE;
+            int minCellY = (y - radius > 0 ? y - radius : 0) / SPATIAL_CELL_SIZE;
+            int maxCellY = (y + radius < HEX_GRID_HEIGHT - 1 ? y + radius : HEX_GRID_HEIGHT - 1) / SPATIAL_CELL_SIZE;
+
+            for (int cellY = minCellY; cellY <= maxCellY; cellY++) {
+                for (int cellX = minCellX; cellX <= maxCellX; cellX++) {
+                    if (scr_spatial_cell_add(&(scr_spatial_cells[elevation][cellY * SPATIAL_GRID_WIDTH + cellX]), script->sid) == -1) {
+                        debug_printf("\nError in mem_realloc in scr_spatial_index_build!\n");
+                    }
+                }
+            }
+        }
+        extent = extent->next;
+    }
+
+    scr_spatial_index_dirty = false;
+}
+
+static void scr_spatial_index_free()
+{
+    for (int elevation = 0; elevation < ELEVATION_COUNT; elevation++) {
+        for (int index = 0; index < SPATIAL_GRID_SIZE; index++) {
+            SpatialCell* cell = &(scr_spatial_cells[elevation][index]);
+            if (cell->sids != NULL) {
+                mem_free(cell->sids);
+                cell->sids = NULL;
+            }
+            cell->length = 0;
+            cell->capacity = 0;
+        }
+    }
+
+    if (scr_spatial_candidates != NULL) {
+        mem_free(scr_spatial_candidates);
+        scr_spatial_candidates = NULL;
+    }
+    scr_spatial_candidates_capacity = 0;
+
+    scr_spatial_index_dirty = true;
+}
+
 // 0x4A677C
 int scr_load_all_scripts()
 {
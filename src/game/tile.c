@@ -1,12 +1,14 @@
 #include "game/tile.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <string.h>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 #include "plib/color/color.h"
+#include "game/cache.h"
 #include "game/config.h"
 #include "plib/gnw/input.h"
 #include "plib/gnw/debug.h"
@@ -16,9 +18,17 @@
 #include "game/light.h"
 #include "game/map.h"
 #include "game/object.h"
+#include "mmx.h"
 
 #define TILE_IS_VALID(tile) ((tile) >= 0 && (tile) < grid_size)
 
+// The maximum number of pending rects in refresh batch (see
+// [tile_refresh_batch_begin]).
+#define REFRESH_RECTS_CAPACITY 16
+
+// The maximum size of shaded floor tiles cache (see [floor_cache]).
+#define FLOOR_CACHE_SIZE (1 << 20)
+
 typedef struct STRUCT_51D99C {
     int field_0;
     int field_4;
@@ -48,12 +58,47 @@ typedef struct STRUCT_51DB48 {
     int field_8;
 } STRUCT_51DB48;
 
+// Header of shaded floor tile in [floor_cache], followed by `width` * `height`
+// shaded pixels.
+typedef struct FloorCacheHeader {
+    int fid;
+    int width;
+    int height;
+
+    // Light intensities of [verticies] the tile was shaded with.
+    int intensities[10];
+} FloorCacheHeader;
+
 static void refresh_mapper(Rect* rect, int elevation);
 static void refresh_game(Rect* rect, int elevation);
 static bool tile_on_edge(int tile);
 static void roof_fill_on(int x, int y, int elevation);
 static void roof_fill_off(int x, int y, int elevation);
 static void roof_draw(int fid, int x, int y, Rect* rect, int light);
+static void tile_refresh_add(Rect* rect);
+static void tile_refresh_flush();
+static void floor_build_intensity_map();
+static unsigned char* floor_cache_lock(int fid, Art* art, CacheEntry** cacheEntryPtr);
+static int floor_cache_size(int key, int* sizePtr);
+static int floor_cache_load(int key, int* sizePtr, unsigned char* data);
+static void floor_cache_free(void* ptr);
+
+// Nesting level of [tile_refresh_batch_begin] calls. While positive
+// refreshed rects are accumulated in [refresh_rects] instead of being
+// rendered immediately.
+static int refresh_batch_depth = 0;
+
+// Pending rects of refresh batch, clipped to [buf_rect].
+static Rect refresh_rects[REFRESH_RECTS_CAPACITY];
+static int refresh_rects_length = 0;
+
+// Total area of rects requested to be refreshed since the last
+// [tile_dump_refresh_stats].
+static unsigned long long refresh_requested_pixels = 0;
+
+// Total area of rects actually rendered since the last
+// [tile_dump_refresh_stats].
+static unsigned long long refresh_rendered_pixels = 0;
 
 // 0x51D950
 static bool borderInitialized = false;
@@ -165,6 +210,19 @@ static STRUCT_51DB48 upside_down_triangles[5] = {
 // 0x668224
 static int intensity_map[3280];
 
+// Cache of floor tiles shaded with non-uniform light, keyed by hash of fid
+// and light intensities of [verticies].
+static Cache floor_cache;
+
+static bool floor_cache_initialized = false;
+
+// Value of [colorGetTablesGeneration] cached tiles were shaded with.
+static unsigned int floor_cache_generation;
+
+// The art of the floor tile being loaded into [floor_cache].
+static Art* floor_cache_art;
+static int floor_cache_fid;
+
 // 0x66B564
 static int dir_tile2[2][6];
 
@@ -421,6 +479,15 @@ int tile_init(TileData** a1, int squareGridWidth, int squareGridHeight, int hexG
         tile_refresh = refresh_mapper;
     }
 
+    if (!floor_cache_initialized) {
+        if (cache_init(&floor_cache, floor_cache_size, floor_cache_load, floor_cache_free, FLOOR_CACHE_SIZE)) {
+            floor_cache_generation = colorGetTablesGeneration();
+            floor_cache_initialized = true;
+        } else {
+            debug_printf("cache_init failed in tile_init\n");
+        }
+    }
+
     return 0;
 }
 
@@ -454,6 +521,12 @@ void tile_reset()
 // NOTE: Uncollapsed 0x4B129C.
 void tile_exit()
 {
+    tile_dump_refresh_stats();
+
+    if (floor_cache_initialized) {
+        cache_exit(&floor_cache);
+        floor_cache_initialized = false;
+    }
 }
 
 // 0x4B12A8
@@ -473,7 +546,17 @@ void tile_refresh_rect(Rect* rect, int elevation)
 {
     if (refresh_enabled) {
         if (elevation == map_elevation) {
-            tile_refresh(rect, elevation);
+            if (refresh_batch_depth > 0) {
+                tile_refresh_add(rect);
+            } else {
+                Rect clipped;
+                if (rect_inside_bound(rect, &buf_rect, &clipped) != -1) {
+                    refresh_requested_pixels += rectGetWidth(&clipped) * rectGetHeight(&clipped);
+                    refresh_rendered_pixels += rectGetWidth(&clipped) * rectGetHeight(&clipped);
+                }
+
+                tile_refresh(rect, elevation);
+            }
         }
     }
 }
@@ -482,10 +565,118 @@ void tile_refresh_rect(Rect* rect, int elevation)
 void tile_refresh_display()
 {
     if (refresh_enabled) {
+        // Everything is about to be rendered, pending rects are no longer
+        // needed.
+        refresh_rects_length = 0;
+
+        refresh_requested_pixels += rectGetWidth(&buf_rect) * rectGetHeight(&buf_rect);
+        refresh_rendered_pixels += rectGetWidth(&buf_rect) * rectGetHeight(&buf_rect);
+
         tile_refresh(&buf_rect, map_elevation);
     }
 }
 
+// Starts accumulating rects passed to [tile_refresh_rect] instead of
+// rendering each of them immediately. Overlapping rects are merged and
+// rendered once by the matching [tile_refresh_batch_end].
+void tile_refresh_batch_begin()
+{
+    refresh_batch_depth++;
+}
+
+void tile_refresh_batch_end()
+{
+    if (refresh_batch_depth > 0) {
+        refresh_batch_depth--;
+        if (refresh_batch_depth == 0) {
+            tile_refresh_flush();
+        }
+    }
+}
+
+// Prints total area (in pixels) of rects requested to be refreshed and total
+// area actually rendered to debug log, and resets both counters.
+void tile_dump_refresh_stats()
+{
+    debug_printf("\ntile refresh: %llu pixels requested, %llu pixels rendered\n",
+        refresh_requested_pixels,
+        refresh_rendered_pixels);
+
+    refresh_requested_pixels = 0;
+    refresh_rendered_pixels = 0;
+}
+
+// Adds rect to refresh batch merging it with pending rects when rendering
+// their bounding rect is not more expensive than rendering both of them.
+static void tile_refresh_add(Rect* rect)
+{
+    Rect pending;
+    if (rect_inside_bound(rect, &buf_rect, &pending) == -1) {
+        return;
+    }
+
+    refresh_requested_pixels += rectGetWidth(&pending) * rectGetHeight(&pending);
+
+    int index = 0;
+    while (index < refresh_rects_length) {
+        Rect* other = &(refresh_rects[index]);
+
+        Rect bound;
+        rect_min_bound(other, &pending, &bound);
+
+        int boundArea = rectGetWidth(&bound) * rectGetHeight(&bound);
+        int separateArea = rectGetWidth(other) * rectGetHeight(other) + rectGetWidth(&pending) * rectGetHeight(&pending);
+        if (boundArea <= separateArea) {
+            // Merged rect can now overlap rects which were checked
+            // before, start over.
+            pending = bound;
+            refresh_rects[index] = refresh_rects[--refresh_rects_length];
+            index = 0;
+        } else {
+            index++;
+        }
+    }
+
+    if (refresh_rects_length == REFRESH_RECTS_CAPACITY) {
+        // Merge with the rect which grows the least.
+        int bestIndex = 0;
+        int bestGrowth = INT_MAX;
+        for (index = 0; index < refresh_rects_length; index++) {
+            Rect bound;
+            rect_min_bound(&(refresh_rects[index]), &pending, &bound);
+
+            int growth = rectGetWidth(&bound) * rectGetHeight(&bound) - rectGetWidth(&(refresh_rects[index])) * rectGetHeight(&(refresh_rects[index]));
+            if (growth < bestGrowth) {
+                bestGrowth = growth;
+                bestIndex = index;
+            }
+        }
+
+        rect_min_bound(&(refresh_rects[bestIndex]), &pending, &pending);
+        refresh_rects[bestIndex] = refresh_rects[--refresh_rects_length];
+    }
+
+    refresh_rects[refresh_rects_length++] = pending;
+}
+
+// Renders pending rects of refresh batch.
+static void tile_refresh_flush()
+{
+    Rect rects[REFRESH_RECTS_CAPACITY];
+    int length = refresh_rects_length;
+    memcpy(rects, refresh_rects, sizeof(*rects) * length);
+    refresh_rects_length = 0;
+
+    if (!refresh_enabled) {
+        return;
+    }
+
+    for (int index = 0; index < length; index++) {
+        refresh_rendered_pixels += rectGetWidth(&(rects[index])) * rectGetHeight(&(rects[index]));
+        tile_refresh(&(rects[index]), map_elevation);
+    }
+}
+
 // 0x4B12F8
 int tile_set_center(int tile, int flags)
 {
@@ -1718,139 +1909,182 @@ void floor_draw(int fid, int x, int y, Rect* rect)
             goto out;
         }
 
-        for (int i = 0; i < 5; i++) {
-            STRUCT_51DB0C* ptr_51DB0C = &(rightside_up_triangles[i]);
-            int v32 = verticies[ptr_51DB0C->field_8].field_C;
-            int v33 = verticies[ptr_51DB0C->field_8].field_0;
-            int v34 = verticies[ptr_51DB0C->field_4].field_C - verticies[ptr_51DB0C->field_0].field_C;
-            // TODO: Probably wrong.
-            int v35 = v34 / 32;
-            int v36 = (verticies[ptr_51DB0C->field_0].field_C - v32) / 13;
-            int* v37 = &(intensity_map[v33]);
-            if (v35 != 0) {
-                if (v36 != 0) {
-                    for (int i = 0; i < 13; i++) {
-                        int v41 = v32;
-                        int v42 = rightside_up_table[i].field_4;
-                        v37 += rightside_up_table[i].field_0;
-                        for (int j = 0; j < v42; j++) {
-                            *v37++ = v41;
-                            v41 += v35;
-                        }
-                        v32 += v36;
-                    }
-                } else {
-                    for (int i = 0; i < 13; i++) {
-                        int v38 = v32;
-                        int v39 = rightside_up_table[i].field_4;
-                        v37 += rightside_up_table[i].field_0;
-                        for (int j = 0; j < v39; j++) {
-                            *v37++ = v38;
-                            v38 += v35;
-                        }
-                    }
-                }
-            } else {
-                if (v36 != 0) {
-                    for (int i = 0; i < 13; i++) {
-                        int v46 = rightside_up_table[i].field_4;
-                        v37 += rightside_up_table[i].field_0;
-                        for (int j = 0; j < v46; j++) {
-                            *v37++ = v32;
-                        }
-                        v32 += v36;
-                    }
-                } else {
-                    for (int i = 0; i < 13; i++) {
-                        int v44 = rightside_up_table[i].field_4;
-                        v37 += rightside_up_table[i].field_0;
-                        for (int j = 0; j < v44; j++) {
-                            *v37++ = v32;
-                        }
-                    }
-                }
-            }
-        }
+        unsigned char* v66 = buf + buf_full * y + x;
+        unsigned char* v67 = art_frame_data(art, 0, 0) + frameWidth * v78 + v79;
 
-        for (int i = 0; i < 5; i++) {
-            STRUCT_51DB48* ptr_51DB48 = &(upside_down_triangles[i]);
-            int v50 = verticies[ptr_51DB48->field_0].field_C;
-            int v51 = verticies[ptr_51DB48->field_0].field_0;
-            int v52 = verticies[ptr_51DB48->field_8].field_C - v50;
-            // TODO: Probably wrong.
-            int v53 = v52 / 32;
-            int v54 = (verticies[ptr_51DB48->field_4].field_C - v50) / 13;
-            int* v55 = &(intensity_map[v51]);
-            if (v53 != 0) {
-                if (v54 != 0) {
-                    for (int i = 0; i < 13; i++) {
-                        int v59 = v50;
-                        int v60 = upside_down_table[i].field_4;
-                        v55 += upside_down_table[i].field_0;
-                        for (int j = 0; j < v60; j++) {
-                            *v55++ = v59;
-                            v59 += v53;
-                        }
-                        v50 += v54;
-                    }
-                } else {
-                    for (int i = 0; i < 13; i++) {
-                        int v56 = v50;
-                        int v57 = upside_down_table[i].field_4;
-                        v55 += upside_down_table[i].field_0;
-                        for (int j = 0; j < v57; j++) {
-                            *v55++ = v56;
-                            v56 += v53;
-                        }
-                    }
-                }
-            } else {
-                if (v54 != 0) {
-                    for (int i = 0; i < 13; i++) {
-                        int v64 = upside_down_table[i].field_4;
-                        v55 += upside_down_table[i].field_0;
-                        for (int j = 0; j < v64; j++) {
-                            *v55++ = v50;
-                        }
-                        v50 += v54;
-                    }
-                } else {
-                    for (int i = 0; i < 13; i++) {
-                        int v62 = upside_down_table[i].field_4;
-                        v55 += upside_down_table[i].field_0;
-                        for (int j = 0; j < v62; j++) {
-                            *v55++ = v50;
-                        }
+        CacheEntry* floorCacheEntry;
+        unsigned char* shaded = floor_cache_lock(fid, art, &floorCacheEntry);
+        if (shaded != NULL) {
+            shaded += frameWidth * v78 + v79;
+
+            while (--v76 != -1) {
+                for (int kk = 0; kk < v77; kk++) {
+                    if (v67[kk] != 0) {
+                        v66[kk] = shaded[kk];
                     }
                 }
+                v66 += buf_full;
+                v67 += frameWidth;
+                shaded += frameWidth;
             }
+
+            cache_unlock(&floor_cache, floorCacheEntry);
+            goto out;
         }
 
-        unsigned char* v66 = buf + buf_full * y + x;
-        unsigned char* v67 = art_frame_data(art, 0, 0) + frameWidth * v78 + v79;
+        floor_build_intensity_map();
+
         int* v68 = &(intensity_map[160 + 80 * v78]) + v79;
-        int v86 = frameWidth - v77;
-        int v85 = buf_full - v77;
-        int v87 = 80 - v77;
-
-        while (--v76 != -1) {
-            for (int kk = 0; kk < v77; kk++) {
-                if (*v67 != 0) {
-                    *v66 = intensityColorTable[*v67][*v68 >> 9];
+        mmxBlitIntensityTrans(v66, buf_full, v67, frameWidth, v68, 80, v77, v76);
+    }
+
+out:
+
+    art_ptr_unlock(cacheEntry);
+}
+
+// Fills [intensity_map] by interpolating light intensities of [verticies]
+// across floor tile triangles.
+static void floor_build_intensity_map()
+{
+    for (int i = 0; i < 5; i++) {
+        STRUCT_51DB0C* ptr_51DB0C = &(rightside_up_triangles[i]);
+        int v32 = verticies[ptr_51DB0C->field_8].field_C;
+        int v33 = verticies[ptr_51DB0C->field_8].field_0;
+        int v34 = verticies[ptr_51DB0C->field_4].field_C - verticies[ptr_51DB0C->field_0].field_C;
+        // TODO: Probably wrong.
+        int v35 = v34 / 32;
+        int v36 = (verticies[ptr_51DB0C->field_0].field_C - v32) / 13;
+        int* v37 = &(intensity_map[v33]);
+
+        // NOTE: Original code has separate loops for zero horizontal and
+        // vertical steps, which produce the same result.
+        for (int i = 0; i < 13; i++) {
+            int v42 = rightside_up_table[i].field_4;
+            v37 += rightside_up_table[i].field_0;
+            mmxFillRamp(v37, v42, v32, v35);
+            v37 += v42;
+            v32 += v36;
+        }
+    }
+
+    for (int i = 0; i < 5; i++) {
+        STRUCT_51DB48* ptr_51DB48 = &(upside_down_triangles[i]);
+        int v50 = verticies[ptr_51DB48->field_0].field_C;
+        int v51 = verticies[ptr_51DB48->field_0].field_0;
+        int v52 = verticies[ptr_51DB48->field_8].field_C - v50;
+        // TODO: Probably wrong.
+        int v53 = v52 / 32;
+        int v54 = (verticies[ptr_51DB48->field_4].field_C - v50) / 13;
+        int* v55 = &(intensity_map[v51]);
+
+        for (int i = 0; i < 13; i++) {
+            int v60 = upside_down_table[i].field_4;
+            v55 += upside_down_table[i].field_0;
+            mmxFillRamp(v55, v60, v50, v53);
+            v55 += v60;
+            v50 += v54;
+        }
+    }
+}
+
+// Returns shaded pixels of the floor tile for current light intensities of
+// [verticies], shading and caching it if needed, or `NULL` if the tile cannot
+// be cached. The returned buffer must be released with [cache_unlock].
+static unsigned char* floor_cache_lock(int fid, Art* art, CacheEntry** cacheEntryPtr)
+{
+    if (!floor_cache_initialized) {
+        return NULL;
+    }
+
+    unsigned int generation = colorGetTablesGeneration();
+    if (generation != floor_cache_generation) {
+        cache_flush(&floor_cache);
+        floor_cache_generation = generation;
+    }
+
+    unsigned int hash = (unsigned int)fid;
+    for (int index = 0; index < 10; index++) {
+        hash = hash * 16777619U ^ (unsigned int)verticies[index].field_C;
+    }
+
+    int key = (int)hash;
+
+    floor_cache_art = art;
+    floor_cache_fid = fid;
+
+    unsigned char* pixels = NULL;
+
+    // Second attempt replaces entry of another tile with the same hash.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        unsigned char* data;
+        if (!cache_lock(&floor_cache, key, (void**)&data, cacheEntryPtr)) {
+            break;
+        }
+
+        FloorCacheHeader* header = (FloorCacheHeader*)data;
+        if (header->fid == fid) {
+            int index;
+            for (index = 0; index < 10; index++) {
+                if (header->intensities[index] != verticies[index].field_C) {
+                    break;
                 }
-                v67++;
-                v68++;
-                v66++;
             }
-            v66 += v85;
-            v68 += v87;
-            v67 += v86;
+
+            if (index == 10) {
+                pixels = data + sizeof(*header);
+                break;
+            }
         }
+
+        cache_unlock(&floor_cache, *cacheEntryPtr);
+        cache_discard(&floor_cache, key);
     }
 
-out:
+    floor_cache_art = NULL;
 
-    art_ptr_unlock(cacheEntry);
+    return pixels;
+}
+
+static int floor_cache_size(int key, int* sizePtr)
+{
+    if (floor_cache_art == NULL) {
+        return -1;
+    }
+
+    int width = art_frame_width(floor_cache_art, 0, 0);
+    int height = art_frame_length(floor_cache_art, 0, 0);
+    *sizePtr = sizeof(FloorCacheHeader) + width * height;
+
+    return 0;
+}
+
+static int floor_cache_load(int key, int* sizePtr, unsigned char* data)
+{
+    if (floor_cache_art == NULL) {
+        return -1;
+    }
+
+    FloorCacheHeader* header = (FloorCacheHeader*)data;
+    header->fid = floor_cache_fid;
+    header->width = art_frame_width(floor_cache_art, 0, 0);
+    header->height = art_frame_length(floor_cache_art, 0, 0);
+    for (int index = 0; index < 10; index++) {
+        header->intensities[index] = verticies[index].field_C;
+    }
+
+    unsigned char* pixels = data + sizeof(*header);
+    memset(pixels, 0, header->width * header->height);
+
+    floor_build_intensity_map();
+    mmxBlitIntensityTrans(pixels, header->width, art_frame_data(floor_cache_art, 0, 0), header->width, &(intensity_map[160]), 80, header->width, header->height);
+
+    return 0;
+}
+
+static void floor_cache_free(void* ptr)
+{
+    // Shaded tiles are stored in cache heap, nothing to free.
 }
 
 // 0x4B372C
@@ -25,6 +25,9 @@ void tile_disable_refresh();
 void tile_enable_refresh();
 void tile_refresh_rect(Rect* rect, int elevation);
 void tile_refresh_display();
+void tile_refresh_batch_begin();
+void tile_refresh_batch_end();
+void tile_dump_refresh_stats();
 int tile_set_center(int tile, int flags);
 void tile_toggle_roof(int a1);
 int tile_roof_visible();
@@ -1,6 +1,7 @@
 #include "int/intrpret.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -17,6 +18,17 @@
 // The maximum number of opcodes.
 #define OPCODE_MAX_COUNT 342
 
+// The maximum length of dynamic string block, lengths are stored as shorts
+// and negated for free blocks.
+#define STRING_BLOCK_LENGTH_MAX 32766
+
+// The minimum length of dynamic string block, enough to hold free list links
+// when the block is freed.
+#define STRING_BLOCK_LENGTH_MIN 8
+
+// The maximum number of entries in [Program.stringsPending].
+#define STRINGS_PENDING_CAPACITY 256
+
 typedef struct ProgramListNode {
     Program* program;
     struct ProgramListNode* next; // next
@@ -28,6 +40,10 @@ static char* defaultFilename(char* fileName);
 static int outputStr(char* string);
 static int checkWait(Program* program);
 static const char* findCurrentProc(Program* program);
+static ProgramImage* programImageLock(const char* path);
+static void programImageUnlock(ProgramImage* image);
+static unsigned int procedureNameHash(const char* name);
+static void programImageIndexProcedures(ProgramImage* image);
 static opcode_t fetchWord(unsigned char* data, int pos);
 static int fetchLong(unsigned char* a1, int a2);
 static void storeWord(int value, unsigned char* a2, int a3);
@@ -44,6 +60,21 @@ static void detachProgram(Program* program);
 static void purgeProgram(Program* program);
 static opcode_t getOp(Program* program);
 static void checkProgramStrings(Program* program);
+static int stringBinIndex(int length);
+static void stringHeapLink(Program* program, int offset);
+static void stringHeapUnlink(Program* program, int offset);
+static void stringHeapRelease(Program* program, int offset);
+static int stringHeapTake(Program* program, int length);
+static void stringHeapCoalesce(Program* program);
+static void stringHeapMarkPending(Program* program, int offset);
+#ifdef INTERPRET_PROFILE
+static unsigned int profileEntryHash(const char* programName, const char* procedureName);
+static int profileEntryFind(const char* programName, const char* procedureName);
+static void profileEntriesGrow();
+static void profileEntriesFree();
+static int profileBegin(Program* program);
+static void profileEnd(int frameIndex);
+#endif
 static void op_noop(Program* program);
 static void op_const(Program* program);
 static void op_push_base(Program* program);
@@ -160,6 +191,76 @@ static ProgramListNode* head;
 // 0x59E794
 static int suspendEvents;
 
+// The list of loaded program images.
+static ProgramImage* programImages;
+
+// The number of times program image was shared instead of being loaded
+// since the last [interpretDumpImageStats].
+static unsigned long long programImagesShared;
+
+// The number of bytes not loaded due to sharing since the last
+// [interpretDumpImageStats].
+static unsigned long long programImagesSharedSize;
+
+// Totals of the above for entire session.
+static unsigned long long programImagesSharedTotal;
+static unsigned long long programImagesSharedSizeTotal;
+
+#ifdef INTERPRET_PROFILE
+// The initial length of [profileEntries]. Must be a power of two.
+#define PROFILE_ENTRIES_INITIAL_LENGTH 256
+
+// The maximum nesting of [interpret] calls tracked by profiler. Instructions
+// executed deeper than that are attributed to the innermost tracked call.
+#define PROFILE_FRAMES_MAX 32
+
+// Execution statistics of a single procedure.
+typedef struct ProfileEntry {
+    // Both are NULL for empty slot.
+    char* programName;
+    char* procedureName;
+
+    // The number of [interpret] calls which started in this procedure.
+    unsigned int calls;
+
+    // The number of instructions executed by this procedure, excluding
+    // nested [interpret] calls.
+    unsigned int instructions;
+
+    // Wall time spent in this procedure excluding (self) and including
+    // (total) nested [interpret] calls, in performance counter ticks.
+    LONGLONG selfTime;
+    LONGLONG totalTime;
+} ProfileEntry;
+
+// Running [interpret] call.
+typedef struct ProfileFrame {
+    int entryIndex;
+    LONGLONG start;
+    LONGLONG childTime;
+    unsigned int instructions;
+} ProfileFrame;
+
+// Open-addressing hash table of procedure statistics keyed by program and
+// procedure names. Entries outlive programs so that statistics of scripts
+// which were unloaded on map change are still available.
+static ProfileEntry* profileEntries;
+
+// The number of slots in [profileEntries], always a power of two.
+static int profileEntriesLength;
+
+// The number of used slots in [profileEntries].
+static int profileEntriesCount;
+
+static ProfileFrame profileFrames[PROFILE_FRAMES_MAX];
+static int profileFramesLength;
+
+// Per-opcode statistics indexed by `opcode & 0x3FF`. Opcode time includes
+// nested [interpret] calls made by opcode handler.
+static unsigned int profileOpcodeCounts[OPCODE_MAX_COUNT];
+static LONGLONG profileOpcodeTimes[OPCODE_MAX_COUNT];
+#endif
+
 // 0x4670A0
 static unsigned int defaultTimerFunc()
 {
@@ -395,6 +496,10 @@ void interpretDecStringRef(Program* program, opcode_t opcode, int value)
         if (*refcountPtr < 0) {
             debug_printf("String ref went negative, this shouldn\'t ever happen\n");
         }
+
+        if (*refcountPtr == 0) {
+            stringHeapMarkPending(program, value - 4);
+        }
     }
 }
 
@@ -527,8 +632,16 @@ void interpretFreeProgram(Program* program)
         myfree(program->dynamicStrings, __FILE__, __LINE__); // "..\\int\\INTRPRET.C", 429
     }
 
-    if (program->data != NULL) {
-        myfree(program->data, __FILE__, __LINE__); // "..\\int\\INTRPRET.C", 430
+    if (program->stringsPending != NULL) {
+        myfree(program->stringsPending, __FILE__, __LINE__);
+    }
+
+    if (program->image != NULL) {
+        programImageUnlock(program->image);
+    }
+
+    if (program->procedures != NULL) {
+        myfree(program->procedures, __FILE__, __LINE__);
     }
 
     if (program->name != NULL) {
@@ -546,14 +659,21 @@ void interpretFreeProgram(Program* program)
     myfree(program, __FILE__, __LINE__); // "..\\int\\INTRPRET.C", 435
 }
 
-// 0x467734
-Program* allocateProgram(const char* path)
+// Returns image of .INT file at [path], loading it if it's not shared by
+// other programs yet.
+static ProgramImage* programImageLock(const char* path)
 {
+    for (ProgramImage* image = programImages; image != NULL; image = image->next) {
+        if (stricmp(image->path, path) == 0) {
+            image->refCount++;
+            programImagesShared++;
+            programImagesSharedSize += image->dataSize;
+            return image;
+        }
+    }
+
     File* stream = db_fopen(path, "rb");
     if (stream == NULL) {
-        char err[260];
-        sprintf(err, "Couldn't open %s for read\n", path);
-        interpretError(err);
         return NULL;
     }
 
@@ -563,6 +683,108 @@ Program* allocateProgram(const char* path)
     db_fread(data, 1, fileSize, stream);
     db_fclose(stream);
 
+    ProgramImage* image = (ProgramImage*)mymalloc(sizeof(*image), __FILE__, __LINE__);
+    image->path = mystrdup(path, __FILE__, __LINE__);
+    image->data = data;
+    image->dataSize = fileSize;
+    image->decodedOpcodes = (opcode_t*)mycalloc(fileSize, sizeof(*image->decodedOpcodes), __FILE__, __LINE__);
+    image->refCount = 1;
+    image->next = programImages;
+    programImages = image;
+
+    programImageIndexProcedures(image);
+
+    return image;
+}
+
+// Hashes [name] ignoring case, so that names equal by [stricmp] have equal
+// hashes.
+static unsigned int procedureNameHash(const char* name)
+{
+    unsigned int hash = 2166136261U;
+    while (*name != '\0') {
+        hash ^= (unsigned char)tolower((unsigned char)*name);
+        hash *= 16777619U;
+        name++;
+    }
+    return hash;
+}
+
+// Builds [ProgramImage.procedureSlots].
+static void programImageIndexProcedures(ProgramImage* image)
+{
+    unsigned char* procedures = image->data + 42;
+    unsigned char* identifiers = sizeof(Procedure) * fetchLong(procedures, 0) + procedures + 4;
+    int procedureCount = fetchLong(procedures, 0);
+
+    int slotsLength = 16;
+    while (slotsLength < procedureCount * 2) {
+        slotsLength *= 2;
+    }
+
+    int* slots = (int*)mymalloc(sizeof(*slots) * slotsLength, __FILE__, __LINE__);
+    for (int index = 0; index < slotsLength; index++) {
+        slots[index] = -1;
+    }
+
+    int mask = slotsLength - 1;
+    unsigned char* ptr = procedures + 4;
+    for (int procedureIndex = 0; procedureIndex < procedureCount; procedureIndex++) {
+        char* name = (char*)(identifiers + fetchLong(ptr, offsetof(Procedure, field_0)));
+
+        // Linear search returns the first procedure with given name, so
+        // duplicates are not indexed.
+        int index = procedureNameHash(name) & mask;
+        while (slots[index] != -1) {
+            unsigned char* other = procedures + 4 + sizeof(Procedure) * slots[index];
+            if (stricmp((char*)(identifiers + fetchLong(other, offsetof(Procedure, field_0))), name) == 0) {
+                break;
+            }
+            index = (index + 1) & mask;
+        }
+
+        if (slots[index] == -1) {
+            slots[index] = procedureIndex;
+        }
+
+        ptr += sizeof(Procedure);
+    }
+
+    image->procedureSlots = slots;
+    image->procedureSlotsLength = slotsLength;
+}
+
+static void programImageUnlock(ProgramImage* image)
+{
+    image->refCount--;
+    if (image->refCount != 0) {
+        return;
+    }
+
+    ProgramImage** nextPtr = &programImages;
+    while (*nextPtr != image) {
+        nextPtr = &((*nextPtr)->next);
+    }
+    *nextPtr = image->next;
+
+    myfree(image->procedureSlots, __FILE__, __LINE__);
+    myfree(image->decodedOpcodes, __FILE__, __LINE__);
+    myfree(image->data, __FILE__, __LINE__);
+    myfree(image->path, __FILE__, __LINE__);
+    myfree(image, __FILE__, __LINE__);
+}
+
+// 0x467734
+Program* allocateProgram(const char* path)
+{
+    ProgramImage* image = programImageLock(path);
+    if (image == NULL) {
+        char err[260];
+        sprintf(err, "Couldn't open %s for read\n", path);
+        interpretError(err);
+        return NULL;
+    }
+
     Program* program = (Program*)mymalloc(sizeof(Program), __FILE__, __LINE__); // ..\\int\\INTRPRET.C, 463
     memset(program, 0, sizeof(Program));
 
@@ -577,9 +799,25 @@ Program* allocateProgram(const char* path)
     program->basePointer = -1;
     program->framePointer = -1;
     program->returnStack = (unsigned char*)mycalloc(1, 4096, __FILE__, __LINE__); // ..\\int\\INTRPRET.C, 473
-    program->data = data;
-    program->procedures = data + 42;
-    program->identifiers = sizeof(Procedure) * fetchLong(program->procedures, 0) + program->procedures + 4;
+    program->image = image;
+    program->data = image->data;
+    program->dataSize = image->dataSize;
+    program->decodedOpcodes = image->decodedOpcodes;
+
+    for (int bin = 0; bin < PROGRAM_STRING_FREE_BINS_LENGTH; bin++) {
+        program->stringFreeBins[bin] = -1;
+    }
+
+    // Procedures table is modified at runtime, so it's copied from the image.
+    // One extra entry is copied because [findCurrentProc] reads past the
+    // last procedure.
+    unsigned char* procedures = image->data + 42;
+    int proceduresSize = 4 + sizeof(Procedure) * (fetchLong(procedures, 0) + 1);
+    int availableSize = image->dataSize - 42;
+    program->procedures = (unsigned char*)mycalloc(1, proceduresSize, __FILE__, __LINE__);
+    memcpy(program->procedures, procedures, proceduresSize < availableSize ? proceduresSize : availableSize);
+
+    program->identifiers = sizeof(Procedure) * fetchLong(procedures, 0) + procedures + 4;
     program->staticStrings = program->identifiers + fetchLong(program->identifiers, 0) + 4;
 
     return program;
@@ -622,53 +860,235 @@ char* interpretGetName(Program* program, int offset)
     return (char*)(program->identifiers + offset);
 }
 
-// Loops thru heap:
-// - mark unreferenced blocks as free.
-// - merge consequtive free blocks as one large block.
+// Frees dynamic strings which have no references.
 //
-// This is done by negating block length:
-// - positive block length - check for ref count.
-// - negative block length - block is free, attempt to merge with next block.
+// Only blocks which lost their last reference or were created since the last
+// call are checked (see [Program.stringsPending]), unless there were too many
+// of them.
 //
 // 0x4679E0
 static void checkProgramStrings(Program* program)
 {
-    unsigned char* ptr;
-    short len;
-    unsigned char* next_ptr;
-    short next_len;
-    short diff;
-
     if (program->dynamicStrings == NULL) {
         return;
     }
 
-    ptr = program->dynamicStrings + 4;
-    while (*(unsigned short*)ptr != 0x8000) {
-        len = *(short*)ptr;
-        if (len < 0) {
-            len = -len;
-            next_ptr = ptr + len + 4;
-
-            if (*(unsigned short*)next_ptr != 0x8000) {
-                next_len = *(short*)next_ptr;
-                if (next_len < 0) {
-                    diff = 4 - next_len;
-                    if (diff + len < 32766) {
-                        len += diff;
-                        *(short*)ptr += next_len - 4;
-                    } else {
-                        debug_printf("merged string would be too long, size %d %d\n", diff, len);
-                    }
+    unsigned char* heap = program->dynamicStrings + 4;
+
+    if (program->stringsSweepAll) {
+        // Mark unreferenced blocks as free, free lists are rebuilt below
+        // together with merging adjacent free blocks.
+        int offset = 0;
+        while (*(unsigned short*)(heap + offset) != 0x8000) {
+            short length = *(short*)(heap + offset);
+            if (length >= 0 && *(short*)(heap + offset + 2) == 0) {
+                *(short*)(heap + offset) = -length;
+            }
+
+            if (length < 0) {
+                length = -length;
+            }
+
+            offset += length + 4;
+        }
+
+        stringHeapCoalesce(program);
+
+        program->stringsSweepAll = false;
+    } else {
+        // Blocks are only freed here, so every pending offset still denotes
+        // block header. Blocks freed earlier in this loop (merged or pending
+        // twice) have negative length and are skipped.
+        for (int index = 0; index < program->stringsPendingLength; index++) {
+            int offset = program->stringsPending[index];
+            if (*(short*)(heap + offset) >= 0 && *(short*)(heap + offset + 2) == 0) {
+                stringHeapRelease(program, offset);
+            }
+        }
+    }
+
+    program->stringsPendingLength = 0;
+}
+
+// Returns index of the free list for dynamic string block of [length].
+static int stringBinIndex(int length)
+{
+    int bin = 0;
+    while (length > 1 && bin < PROGRAM_STRING_FREE_BINS_LENGTH - 1) {
+        length >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+// Adds free block at [offset] to the appropriate free list.
+static void stringHeapLink(Program* program, int offset)
+{
+    unsigned char* heap = program->dynamicStrings + 4;
+    int bin = stringBinIndex(-*(short*)(heap + offset));
+    int next = program->stringFreeBins[bin];
+
+    *(int*)(heap + offset + 4) = -1;
+    *(int*)(heap + offset + 8) = next;
+
+    if (next != -1) {
+        *(int*)(heap + next + 4) = offset;
+    }
+
+    program->stringFreeBins[bin] = offset;
+}
+
+// Removes free block at [offset] from it's free list.
+static void stringHeapUnlink(Program* program, int offset)
+{
+    unsigned char* heap = program->dynamicStrings + 4;
+    int prev = *(int*)(heap + offset + 4);
+    int next = *(int*)(heap + offset + 8);
+
+    if (prev != -1) {
+        *(int*)(heap + prev + 8) = next;
+    } else {
+        program->stringFreeBins[stringBinIndex(-*(short*)(heap + offset))] = next;
+    }
+
+    if (next != -1) {
+        *(int*)(heap + next + 4) = prev;
+    }
+}
+
+// Frees block at [offset] merging it with consequtive free blocks. Preceding
+// free blocks are merged later by [stringHeapCoalesce].
+static void stringHeapRelease(Program* program, int offset)
+{
+    unsigned char* heap = program->dynamicStrings + 4;
+    int length = *(short*)(heap + offset);
+
+    while (true) {
+        unsigned char* next = heap + offset + length + 4;
+        if (*(unsigned short*)next == 0x8000) {
+            break;
+        }
+
+        short nextLength = *(short*)next;
+        if (nextLength >= 0) {
+            break;
+        }
+
+        if (length + 4 - nextLength >= STRING_BLOCK_LENGTH_MAX) {
+            debug_printf("merged string would be too long, size %d %d\n", 4 - nextLength, length);
+            break;
+        }
+
+        stringHeapUnlink(program, next - heap);
+        length += 4 - nextLength;
+    }
+
+    *(short*)(heap + offset) = -length;
+    *(short*)(heap + offset + 2) = 0;
+    stringHeapLink(program, offset);
+
+    program->stringsFragmented = true;
+}
+
+// Takes free block which can hold [length] bytes from free lists, splitting
+// it if it's much larger. Returns offset of the block, or -1 if there is no
+// such block.
+static int stringHeapTake(Program* program, int length)
+{
+    unsigned char* heap = program->dynamicStrings + 4;
+
+    for (int bin = stringBinIndex(length); bin < PROGRAM_STRING_FREE_BINS_LENGTH; bin++) {
+        int offset = program->stringFreeBins[bin];
+        while (offset != -1) {
+            int blockLength = -*(short*)(heap + offset);
+            if (blockLength >= length) {
+                stringHeapUnlink(program, offset);
+
+                int remainingLength = blockLength - length - 4;
+                if (remainingLength >= STRING_BLOCK_LENGTH_MIN) {
+                    int remainingOffset = offset + length + 4;
+                    *(short*)(heap + remainingOffset) = -remainingLength;
+                    *(short*)(heap + remainingOffset + 2) = 0;
+                    stringHeapLink(program, remainingOffset);
+
+                    blockLength = length;
                 }
+
+                *(short*)(heap + offset) = blockLength;
+                *(short*)(heap + offset + 2) = 0;
+
+                return offset;
             }
-        } else if (*(short*)(ptr + 2) == 0) {
-            *(short*)ptr = -len;
-            *(short*)(ptr + 2) = 0;
+
+            offset = *(int*)(heap + offset + 8);
         }
+    }
 
-        ptr += len + 4;
+    return -1;
+}
+
+// Merges every run of consecutive free blocks into one block and rebuilds
+// free lists.
+static void stringHeapCoalesce(Program* program)
+{
+    unsigned char* heap = program->dynamicStrings + 4;
+
+    for (int bin = 0; bin < PROGRAM_STRING_FREE_BINS_LENGTH; bin++) {
+        program->stringFreeBins[bin] = -1;
+    }
+
+    int offset = 0;
+    while (*(unsigned short*)(heap + offset) != 0x8000) {
+        int length = *(short*)(heap + offset);
+        if (length < 0) {
+            length = -length;
+
+            while (true) {
+                unsigned char* next = heap + offset + length + 4;
+                if (*(unsigned short*)next == 0x8000) {
+                    break;
+                }
+
+                short nextLength = *(short*)next;
+                if (nextLength >= 0) {
+                    break;
+                }
+
+                if (length + 4 - nextLength >= STRING_BLOCK_LENGTH_MAX) {
+                    break;
+                }
+
+                length += 4 - nextLength;
+            }
+
+            *(short*)(heap + offset) = -length;
+            *(short*)(heap + offset + 2) = 0;
+            stringHeapLink(program, offset);
+        }
+
+        offset += length + 4;
+    }
+
+    program->stringsFragmented = false;
+}
+
+// Remembers block at [offset] to be checked by [checkProgramStrings].
+static void stringHeapMarkPending(Program* program, int offset)
+{
+    if (program->stringsSweepAll) {
+        return;
+    }
+
+    if (program->stringsPending == NULL) {
+        program->stringsPending = (int*)mymalloc(sizeof(*program->stringsPending) * STRINGS_PENDING_CAPACITY, __FILE__, __LINE__);
+    }
+
+    if (program->stringsPendingLength == STRINGS_PENDING_CAPACITY) {
+        program->stringsSweepAll = true;
+        return;
     }
+
+    program->stringsPending[program->stringsPendingLength++] = offset;
 }
 
 // 0x467A80
@@ -689,36 +1109,36 @@ int interpretAddString(Program* program, char* string)
         v27++;
     }
 
+    // NOTE: Original code reuses existing block with the same string, and
+    // finds free block with first-fit scan over entire heap. Identical
+    // strings are now stored separately, which makes allocation independent
+    // of heap size.
+    if (v27 < STRING_BLOCK_LENGTH_MIN) {
+        v27 = STRING_BLOCK_LENGTH_MIN;
+    }
+
     if (program->dynamicStrings != NULL) {
-        // TODO: Needs testing, lots of pointer stuff.
-        unsigned char* heap = program->dynamicStrings + 4;
-        while (*(unsigned short*)heap != 0x8000) {
-            short v2 = *(short*)heap;
-            if (v2 >= 0) {
-                if (v2 == v27) {
-                    if (strcmp(string, (char*)(heap + 4)) == 0) {
-                        return (heap + 4) - (program->dynamicStrings + 4);
-                    }
-                }
-            } else {
-                v2 = -v2;
-                if (v2 > v27) {
-                    if (v2 - v27 <= 4) {
-                        *(short*)heap = v2;
-                    } else {
-                        *(short*)(heap + v27 + 6) = 0;
-                        *(short*)(heap + v27 + 4) = -(v2 - v27 - 4);
-                        *(short*)(heap) = v27;
-                    }
+        int offset = stringHeapTake(program, v27);
+
+        // Free blocks released one by one are only merged with the following
+        // ones, so a string growing by concatenation never fits into the
+        // space of it's previous value. Merge adjacent free blocks before
+        // growing the heap.
+        if (offset == -1 && program->stringsFragmented) {
+            stringHeapCoalesce(program);
+            offset = stringHeapTake(program, v27);
+        }
 
-                    *(short*)(heap + 2) = 0;
-                    strcpy((char*)(heap + 4), string);
+        if (offset != -1) {
+            unsigned char* heap = program->dynamicStrings + 4 + offset;
+            int length = *(short*)heap;
 
-                    *(heap + v27 + 3) = '\0';
-                    return (heap + 4) - (program->dynamicStrings + 4);
-                }
-            }
-            heap += v2 + 4;
+            strcpy((char*)(heap + 4), string);
+            *(heap + length + 3) = '\0';
+
+            stringHeapMarkPending(program, offset);
+
+            return offset + 4;
         }
     } else {
         program->dynamicStrings = (unsigned char*)mymalloc(8, __FILE__, __LINE__); // "..\\int\\INTRPRET.C", 631
@@ -746,6 +1166,8 @@ int interpretAddString(Program* program, char* string)
     *(unsigned short*)(v23 + 4) = 0x8000;
     *(short*)(v23 + 6) = 1;
 
+    stringHeapMarkPending(program, v20 - (program->dynamicStrings + 4));
+
     return v20 + 4 - (program->dynamicStrings + 4);
 }
 
@@ -3313,8 +3735,221 @@ void interpretClose()
 {
     exportClose();
     intlibClose();
+
+    programImagesSharedTotal += programImagesShared;
+    programImagesSharedSizeTotal += programImagesSharedSize;
+
+    debug_printf("Program images shared %llu times, %llu bytes saved in total\n", programImagesSharedTotal, programImagesSharedSizeTotal);
+
+#ifdef INTERPRET_PROFILE
+    profileEntriesFree();
+#endif
+}
+
+// Prints the number of times program images were shared and the number of
+// bytes saved to debug log, and resets both counters.
+void interpretDumpImageStats()
+{
+    debug_printf("\nProgram images shared %llu times, %llu bytes saved\n", programImagesShared, programImagesSharedSize);
+
+    programImagesSharedTotal += programImagesShared;
+    programImagesSharedSizeTotal += programImagesSharedSize;
+
+    programImagesShared = 0;
+    programImagesSharedSize = 0;
 }
 
+#ifdef INTERPRET_PROFILE
+static unsigned int profileEntryHash(const char* programName, const char* procedureName)
+{
+    unsigned int hash = procedureNameHash(programName);
+    return (hash ^ procedureNameHash(procedureName)) * 16777619U;
+}
+
+// Returns index of [profileEntries] slot for given procedure, creating it
+// if needed.
+static int profileEntryFind(const char* programName, const char* procedureName)
+{
+    if (profileEntriesCount * 4 >= profileEntriesLength * 3) {
+        profileEntriesGrow();
+    }
+
+    unsigned int mask = profileEntriesLength - 1;
+    unsigned int index = profileEntryHash(programName, procedureName) & mask;
+    while (profileEntries[index].programName != NULL) {
+        ProfileEntry* entry = &(profileEntries[index]);
+        if (strcmp(entry->programName, programName) == 0 && strcmp(entry->procedureName, procedureName) == 0) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+
+    profileEntries[index].programName = mystrdup(programName, __FILE__, __LINE__);
+    profileEntries[index].procedureName = mystrdup(procedureName, __FILE__, __LINE__);
+    profileEntriesCount++;
+
+    return index;
+}
+
+static void profileEntriesGrow()
+{
+    ProfileEntry* oldEntries = profileEntries;
+    int oldLength = profileEntriesLength;
+
+    profileEntriesLength = oldLength != 0 ? oldLength * 2 : PROFILE_ENTRIES_INITIAL_LENGTH;
+    profileEntries = (ProfileEntry*)mycalloc(profileEntriesLength, sizeof(*profileEntries), __FILE__, __LINE__);
+
+    unsigned int mask = profileEntriesLength - 1;
+    for (int oldIndex = 0; oldIndex < oldLength; oldIndex++) {
+        ProfileEntry* entry = &(oldEntries[oldIndex]);
+        if (entry->programName != NULL) {
+            unsigned int index = profileEntryHash(entry->programName, entry->procedureName) & mask;
+            while (profileEntries[index].programName != NULL) {
+                index = (index + 1) & mask;
+            }
+            profileEntries[index] = *entry;
+        }
+    }
+
+    // Running frames refer to entries by index.
+    for (int frameIndex = 0; frameIndex < profileFramesLength; frameIndex++) {
+        ProfileEntry* entry = &(oldEntries[profileFrames[frameIndex].entryIndex]);
+        profileFrames[frameIndex].entryIndex = profileEntryFind(entry->programName, entry->procedureName);
+    }
+
+    if (oldEntries != NULL) {
+        myfree(oldEntries, __FILE__, __LINE__);
+    }
+}
+
+static void profileEntriesFree()
+{
+    for (int index = 0; index < profileEntriesLength; index++) {
+        ProfileEntry* entry = &(profileEntries[index]);
+        if (entry->programName != NULL) {
+            myfree(entry->programName, __FILE__, __LINE__);
+            myfree(entry->procedureName, __FILE__, __LINE__);
+        }
+    }
+
+    if (profileEntries != NULL) {
+        myfree(profileEntries, __FILE__, __LINE__);
+        profileEntries = NULL;
+    }
+
+    profileEntriesLength = 0;
+    profileEntriesCount = 0;
+}
+
+// Starts tracking [interpret] call, attributing it to the procedure at
+// program's current instruction pointer.
+//
+// Returns index of new frame which should be passed to [profileEnd], or -1
+// if the call is nested too deep.
+static int profileBegin(Program* program)
+{
+    if (profileFramesLength >= PROFILE_FRAMES_MAX) {
+        return -1;
+    }
+
+    int entryIndex = profileEntryFind(program->name, findCurrentProc(program));
+    profileEntries[entryIndex].calls++;
+
+    ProfileFrame* frame = &(profileFrames[profileFramesLength]);
+    frame->entryIndex = entryIndex;
+    frame->childTime = 0;
+    frame->instructions = 0;
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    frame->start = now.QuadPart;
+
+    return profileFramesLength++;
+}
+
+// Stops tracking [interpret] call started with [profileBegin], as well as
+// nested calls which were abandoned due to script errors.
+static void profileEnd(int frameIndex)
+{
+    if (frameIndex == -1) {
+        return;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    while (profileFramesLength > frameIndex) {
+        ProfileFrame* frame = &(profileFrames[--profileFramesLength]);
+        ProfileEntry* entry = &(profileEntries[frame->entryIndex]);
+        LONGLONG elapsed = now.QuadPart - frame->start;
+
+        entry->instructions += frame->instructions;
+        entry->totalTime += elapsed;
+        entry->selfTime += elapsed - frame->childTime;
+
+        if (profileFramesLength > 0) {
+            profileFrames[profileFramesLength - 1].childTime += elapsed;
+        }
+    }
+}
+
+// Clears collected statistics.
+void interpretProfileReset()
+{
+    for (int index = 0; index < profileEntriesLength; index++) {
+        ProfileEntry* entry = &(profileEntries[index]);
+        entry->calls = 0;
+        entry->instructions = 0;
+        entry->selfTime = 0;
+        entry->totalTime = 0;
+    }
+
+    memset(profileOpcodeCounts, 0, sizeof(profileOpcodeCounts));
+    memset(profileOpcodeTimes, 0, sizeof(profileOpcodeTimes));
+}
+
+// Writes collected statistics to [path] as CSV, times are in microseconds.
+void interpretProfileDump(const char* path)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    File* stream = db_fopen(path, "wt");
+    if (stream == NULL) {
+        debug_printf("Can't open %s for writing\n", path);
+        return;
+    }
+
+    db_fprintf(stream, "program,procedure,calls,instructions,self_us,total_us\n");
+    for (int index = 0; index < profileEntriesLength; index++) {
+        ProfileEntry* entry = &(profileEntries[index]);
+        if (entry->programName != NULL && entry->calls != 0) {
+            db_fprintf(stream, "%s,%s,%u,%u,%.0f,%.0f\n",
+                entry->programName,
+                entry->procedureName,
+                entry->calls,
+                entry->instructions,
+                (double)entry->selfTime * 1000000.0 / (double)frequency.QuadPart,
+                (double)entry->totalTime * 1000000.0 / (double)frequency.QuadPart);
+        }
+    }
+
+    db_fprintf(stream, "\nopcode,count,total_us\n");
+    for (int index = 0; index < OPCODE_MAX_COUNT; index++) {
+        if (profileOpcodeCounts[index] != 0) {
+            db_fprintf(stream, "%04X,%u,%.0f\n",
+                index | 0x8000,
+                profileOpcodeCounts[index],
+                (double)profileOpcodeTimes[index] * 1000000.0 / (double)frequency.QuadPart);
+        }
+    }
+
+    db_fclose(stream);
+
+    debug_printf("Interpreter profile written to %s\n", path);
+}
+#endif
+
 // NOTE: Unused.
 //
 // 0x46CC74
@@ -3359,9 +3994,16 @@ void interpret(Program* program, int a2)
 
     currentProgram = program;
 
+#ifdef INTERPRET_PROFILE
+    int profileFrameIndex = profileBegin(program);
+#endif
+
     if (setjmp(program->env)) {
         currentProgram = oldCurrentProgram;
         program->flags |= PROGRAM_FLAG_EXITED | PROGRAM_FLAG_0x04;
+#ifdef INTERPRET_PROFILE
+        profileEnd(profileFrameIndex);
+#endif
         return;
     }
 
@@ -3393,26 +4035,59 @@ void interpret(Program* program, int a2)
             program->flags &= ~PROGRAM_IS_WAITING;
         }
 
-        // NOTE: Uninline.
-        opcode_t opcode = getOp(program);
+        int instructionPointer = program->instructionPointer;
+        opcode_t opcode;
+        if (instructionPointer >= 0
+            && instructionPointer < program->dataSize - 1
+            && program->decodedOpcodes[instructionPointer] != 0) {
+            // This opcode was already validated when it was executed for the
+            // first time.
+            opcode = program->decodedOpcodes[instructionPointer];
+            program->instructionPointer = instructionPointer + 2;
+
+            // TODO: Replace with field_82 and field_80?
+            program->flags &= 0xFFFF;
+            program->flags |= (opcode << 16);
+        } else {
+            // NOTE: Uninline.
+            opcode = getOp(program);
 
-        // TODO: Replace with field_82 and field_80?
-        program->flags &= 0xFFFF;
-        program->flags |= (opcode << 16);
+            // TODO: Replace with field_82 and field_80?
+            program->flags &= 0xFFFF;
+            program->flags |= (opcode << 16);
+
+            if (!((opcode >> 8) & 0x80)) {
+                sprintf(err, "Bad opcode %x %c %d.", opcode, opcode, opcode);
+                interpretError(err);
+            }
 
-        if (!((opcode >> 8) & 0x80)) {
-            sprintf(err, "Bad opcode %x %c %d.", opcode, opcode, opcode);
-            interpretError(err);
+            if (opTable[opcode & 0x3FF] == NULL) {
+                sprintf(err, "Undefined opcode %x.", opcode);
+                interpretError(err);
+            }
+
+            if (instructionPointer >= 0 && instructionPointer < program->dataSize - 1) {
+                program->decodedOpcodes[instructionPointer] = opcode;
+            }
         }
 
-        unsigned int opcodeIndex = opcode & 0x3FF;
-        OpcodeHandler* handler = opTable[opcodeIndex];
-        if (handler == NULL) {
-            sprintf(err, "Undefined opcode %x.", opcode);
-            interpretError(err);
+#ifdef INTERPRET_PROFILE
+        if (profileFramesLength > 0) {
+            profileFrames[profileFramesLength - 1].instructions++;
         }
 
-        handler(program);
+        LARGE_INTEGER opcodeStart;
+        LARGE_INTEGER opcodeEnd;
+        QueryPerformanceCounter(&opcodeStart);
+#endif
+
+        opTable[opcode & 0x3FF](program);
+
+#ifdef INTERPRET_PROFILE
+        QueryPerformanceCounter(&opcodeEnd);
+        profileOpcodeCounts[opcode & 0x3FF]++;
+        profileOpcodeTimes[opcode & 0x3FF] += opcodeEnd.QuadPart - opcodeStart.QuadPart;
+#endif
     }
 
     if ((program->flags & PROGRAM_FLAG_EXITED) != 0) {
@@ -3429,6 +4104,10 @@ void interpret(Program* program, int a2)
     currentProgram = oldCurrentProgram;
 
     checkProgramStrings(program);
+
+#ifdef INTERPRET_PROFILE
+    profileEnd(profileFrameIndex);
+#endif
 }
 
 // Prepares program stacks for executing proc at [address].
@@ -3569,16 +4248,18 @@ void executeProc(Program* program, int procedureIndex)
 // 0x46DCD0
 int interpretFindProcedure(Program* program, const char* name)
 {
-    int procedureCount = fetchLong(program->procedures, 0);
-
-    unsigned char* ptr = program->procedures + 4;
-    for (int index = 0; index < procedureCount; index++) {
+    ProgramImage* image = program->image;
+    int mask = image->procedureSlotsLength - 1;
+    int index = procedureNameHash(name) & mask;
+    while (image->procedureSlots[index] != -1) {
+        int procedureIndex = image->procedureSlots[index];
+        unsigned char* ptr = program->procedures + 4 + sizeof(Procedure) * procedureIndex;
         int identifierOffset = fetchLong(ptr, offsetof(Procedure, field_0));
         if (stricmp((char*)(program->identifiers + identifierOffset), name) == 0) {
-            return index;
+            return procedureIndex;
         }
 
-        ptr += sizeof(Procedure);
+        index = (index + 1) & mask;
     }
 
     return -1;
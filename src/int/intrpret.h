@@ -131,6 +131,39 @@ typedef struct Procedure {
     int field_14;
 } Procedure;
 
+// Immutable contents of .INT file shared by all programs loaded from it.
+//
+// Procedures table is the only part of the file modified at runtime (timed
+// and conditional calls), so every [Program] has it's own copy of it.
+typedef struct ProgramImage {
+    char* path;
+    unsigned char* data;
+
+    // The size of [data] in bytes.
+    int dataSize;
+
+    // Native-endian copies of opcodes already executed, indexed by their
+    // position in [data], or 0 if opcode at given position was not executed
+    // yet. Valid opcodes always have high bit set, so 0 is never ambiguous.
+    opcode_t* decodedOpcodes;
+
+    // Open-addressing hash table of procedure indexes keyed by case-folded
+    // procedure name, -1 denotes empty slot. See [interpretFindProcedure].
+    int* procedureSlots;
+
+    // The number of slots in [procedureSlots], always a power of two.
+    int procedureSlotsLength;
+
+    // The number of programs using this image.
+    int refCount;
+
+    struct ProgramImage* next;
+} ProgramImage;
+
+// The number of segregated free lists of dynamic strings. Free list at index
+// `n` holds free blocks with length in [2^n, 2^(n+1)) range.
+#define PROGRAM_STRING_FREE_BINS_LENGTH 16
+
 typedef struct Program Program;
 typedef int(InterpretCheckWaitFunc)(Program* program);
 
@@ -160,6 +193,31 @@ typedef struct Program {
     int flags; // flags
     int windowId;
     bool exited;
+
+    // The image [data] belongs to, [identifiers] and [staticStrings] point
+    // into it as well, while [procedures] is owned by this program.
+    ProgramImage* image;
+
+    // Copied from [image] for quick access.
+    int dataSize;
+    opcode_t* decodedOpcodes;
+
+    // Heads of the segregated free lists of [dynamicStrings], or -1 if list
+    // is empty. Free blocks are linked via offsets stored in their data.
+    int stringFreeBins[PROGRAM_STRING_FREE_BINS_LENGTH];
+
+    // Offsets of dynamic string blocks which had no references at some
+    // point since the last [checkProgramStrings].
+    int* stringsPending;
+    int stringsPendingLength;
+
+    // Set when [stringsPending] overflows, in this case entire heap is swept
+    // by the next [checkProgramStrings].
+    bool stringsSweepAll;
+
+    // Set when a block was freed since the last merge of adjacent free
+    // blocks (see [stringHeapCoalesce]).
+    bool stringsFragmented;
 } Program;
 
 typedef char*(InterpretMangleFunc)(char* fileName);
@@ -184,6 +242,7 @@ char* interpretGetName(Program* program, int offset);
 int interpretAddString(Program* program, char* string);
 void initInterpreter();
 void interpretClose();
+void interpretDumpImageStats();
 void interpretEnableInterpreter(int enabled);
 void interpret(Program* program, int a2);
 void executeProc(Program* program, int procedureIndex);
@@ -204,4 +263,9 @@ void interpretResumeEvents();
 int interpretSaveProgramState();
 void interpretDumpStringHeap();
 
+#ifdef INTERPRET_PROFILE
+void interpretProfileReset();
+void interpretProfileDump(const char* path);
+#endif
+
 #endif /* FALLOUT_INT_INTRPRET_H_ */
@@ -1,9 +1,14 @@
 #include "mmx.h"
 
+#include <emmintrin.h>
 #include <string.h>
 
+#include "plib/color/color.h"
 #include "plib/gnw/svga.h"
 
+// The number of pixels processed by one iteration of SSE2 kernels.
+#define SSE2_BLOCK_SIZE 16
+
 // Return `true` if CPU supports MMX.
 //
 // 0x4E08A0
@@ -24,6 +29,22 @@ bool mmxIsSupported()
     return v1 != 0;
 }
 
+// Return `true` if CPU supports SSE2.
+bool sse2IsSupported()
+{
+    int v1;
+
+    __asm
+    {
+        mov eax, 1
+        cpuid
+        and edx, 0x4000000
+        mov v1, edx
+    }
+
+    return v1 != 0;
+}
+
 // 0x4E0DB0
 void mmxBlit(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int width, int height)
 {
@@ -66,3 +87,314 @@ void mmxBlitTrans(unsigned char* dest, int destPitch, unsigned char* src, int sr
         }
     }
 }
+
+// Copies non-transparent pixels from `src` shading them with `light`. Colors
+// in palette animation range (0xE5 and up) are copied as is.
+void mmxBlitDarkTrans(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int width, int height, int light)
+{
+    int lightModifier = light >> 9;
+
+    if (sse2Enabled) {
+        // Gather the column of `intensityColorTable` for given light into
+        // contiguous table, so that lookups touch 256 bytes instead of 256
+        // cache lines.
+        unsigned char shades[256];
+        for (int index = 0; index < 256; index++) {
+            shades[index] = index < 0xE5 ? intensityColorTable[index][lightModifier] : (unsigned char)index;
+        }
+
+        __m128i zero = _mm_setzero_si128();
+        unsigned char block[SSE2_BLOCK_SIZE];
+
+        for (int y = 0; y < height; y++) {
+            int x = 0;
+            for (; x + SSE2_BLOCK_SIZE <= width; x += SSE2_BLOCK_SIZE) {
+                __m128i pixels = _mm_loadu_si128((__m128i*)(src + x));
+                __m128i transparent = _mm_cmpeq_epi8(pixels, zero);
+                int transparentMask = _mm_movemask_epi8(transparent);
+                if (transparentMask == 0xFFFF) {
+                    continue;
+                }
+
+                for (int index = 0; index < SSE2_BLOCK_SIZE; index++) {
+                    block[index] = shades[src[x + index]];
+                }
+
+                __m128i shaded = _mm_loadu_si128((__m128i*)block);
+                if (transparentMask != 0) {
+                    __m128i background = _mm_loadu_si128((__m128i*)(dest + x));
+                    shaded = _mm_or_si128(_mm_and_si128(transparent, background), _mm_andnot_si128(transparent, shaded));
+                }
+                _mm_storeu_si128((__m128i*)(dest + x), shaded);
+            }
+
+            for (; x < width; x++) {
+                unsigned char b = src[x];
+                if (b != 0) {
+                    dest[x] = shades[b];
+                }
+            }
+
+            src += srcPitch;
+            dest += destPitch;
+        }
+    } else {
+        int srcSkip = srcPitch - width;
+        int destSkip = destPitch - width;
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                unsigned char b = *src;
+                if (b != 0) {
+                    if (b < 0xE5) {
+                        b = intensityColorTable[b][lightModifier];
+                    }
+
+                    *dest = b;
+                }
+
+                src++;
+                dest++;
+            }
+
+            src += srcSkip;
+            dest += destSkip;
+        }
+    }
+}
+
+// Copies non-transparent pixels from `src` shading each of them with the
+// corresponding value from `intensities`.
+void mmxBlitIntensityTrans(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int* intensities, int intensitiesPitch, int width, int height)
+{
+    if (sse2Enabled) {
+        unsigned char* table = &(intensityColorTable[0][0]);
+        __m128i zero = _mm_setzero_si128();
+        unsigned short indexes[SSE2_BLOCK_SIZE];
+        unsigned char block[SSE2_BLOCK_SIZE];
+
+        for (int y = 0; y < height; y++) {
+            int x = 0;
+            for (; x + SSE2_BLOCK_SIZE <= width; x += SSE2_BLOCK_SIZE) {
+                __m128i pixels = _mm_loadu_si128((__m128i*)(src + x));
+                __m128i transparent = _mm_cmpeq_epi8(pixels, zero);
+                int transparentMask = _mm_movemask_epi8(transparent);
+                if (transparentMask == 0xFFFF) {
+                    continue;
+                }
+
+                // Build `intensityColorTable` offsets (color * 256 + light)
+                // for the whole block. Shifted intensities are in 0..128
+                // range, so they can be safely packed into 16 bits.
+                __m128i light0 = _mm_srai_epi32(_mm_loadu_si128((__m128i*)(intensities + x)), 9);
+                __m128i light1 = _mm_srai_epi32(_mm_loadu_si128((__m128i*)(intensities + x + 4)), 9);
+                __m128i light2 = _mm_srai_epi32(_mm_loadu_si128((__m128i*)(intensities + x + 8)), 9);
+                __m128i light3 = _mm_srai_epi32(_mm_loadu_si128((__m128i*)(intensities + x + 12)), 9);
+                __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(zero, pixels), _mm_packs_epi32(light0, light1));
+                __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(zero, pixels), _mm_packs_epi32(light2, light3));
+                _mm_storeu_si128((__m128i*)indexes, lo);
+                _mm_storeu_si128((__m128i*)(indexes + 8), hi);
+
+                for (int index = 0; index < SSE2_BLOCK_SIZE; index++) {
+                    block[index] = table[indexes[index]];
+                }
+
+                __m128i shaded = _mm_loadu_si128((__m128i*)block);
+                if (transparentMask != 0) {
+                    __m128i background = _mm_loadu_si128((__m128i*)(dest + x));
+                    shaded = _mm_or_si128(_mm_and_si128(transparent, background), _mm_andnot_si128(transparent, shaded));
+                }
+                _mm_storeu_si128((__m128i*)(dest + x), shaded);
+            }
+
+            for (; x < width; x++) {
+                unsigned char b = src[x];
+                if (b != 0) {
+                    dest[x] = intensityColorTable[b][intensities[x] >> 9];
+                }
+            }
+
+            src += srcPitch;
+            dest += destPitch;
+            intensities += intensitiesPitch;
+        }
+    } else {
+        int srcSkip = srcPitch - width;
+        int destSkip = destPitch - width;
+        int intensitiesSkip = intensitiesPitch - width;
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (*src != 0) {
+                    *dest = intensityColorTable[*src][*intensities >> 9];
+                }
+
+                src++;
+                intensities++;
+                dest++;
+            }
+
+            src += srcSkip;
+            dest += destSkip;
+            intensities += intensitiesSkip;
+        }
+    }
+}
+
+// Copies non-transparent pixels from `src` shading them with `light`. Pixels
+// with non-zero `mask` are mixed with `dest`, the mask value is the weight of
+// the source pixel (0..128).
+void mmxBlitIntensityMask(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, unsigned char* mask, int maskPitch, int width, int height, int light)
+{
+    int lightModifier = light >> 9;
+
+    if (sse2Enabled) {
+        unsigned char shades[256];
+        for (int index = 0; index < 256; index++) {
+            shades[index] = intensityColorTable[index][lightModifier];
+        }
+
+        unsigned char* intensities = &(intensityColorTable[0][0]);
+        unsigned char* mixes = &(colorMixAddTable[0][0]);
+        __m128i zero = _mm_setzero_si128();
+        __m128i maskMax = _mm_set1_epi16(128);
+        unsigned short indexes[SSE2_BLOCK_SIZE];
+        unsigned char block[SSE2_BLOCK_SIZE];
+        unsigned char backgroundBlock[SSE2_BLOCK_SIZE];
+
+        for (int y = 0; y < height; y++) {
+            int x = 0;
+            for (; x + SSE2_BLOCK_SIZE <= width; x += SSE2_BLOCK_SIZE) {
+                __m128i pixels = _mm_loadu_si128((__m128i*)(src + x));
+                __m128i transparent = _mm_cmpeq_epi8(pixels, zero);
+                int transparentMask = _mm_movemask_epi8(transparent);
+                if (transparentMask == 0xFFFF) {
+                    continue;
+                }
+
+                for (int index = 0; index < SSE2_BLOCK_SIZE; index++) {
+                    block[index] = shades[src[x + index]];
+                }
+
+                __m128i shaded = _mm_loadu_si128((__m128i*)block);
+                __m128i background = _mm_loadu_si128((__m128i*)(dest + x));
+                __m128i weights = _mm_loadu_si128((__m128i*)(mask + x));
+                __m128i unmasked = _mm_cmpeq_epi8(weights, zero);
+
+                if (_mm_movemask_epi8(unmasked) != 0xFFFF) {
+                    // Shade background with inverted weights, offsets into
+                    // `intensityColorTable` are color * 256 + weight.
+                    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(zero, background), _mm_sub_epi16(maskMax, _mm_unpacklo_epi8(weights, zero)));
+                    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(zero, background), _mm_sub_epi16(maskMax, _mm_unpackhi_epi8(weights, zero)));
+                    _mm_storeu_si128((__m128i*)indexes, lo);
+                    _mm_storeu_si128((__m128i*)(indexes + 8), hi);
+
+                    for (int index = 0; index < SSE2_BLOCK_SIZE; index++) {
+                        backgroundBlock[index] = intensities[indexes[index]];
+                    }
+
+                    // Shade source with weights.
+                    lo = _mm_add_epi16(_mm_unpacklo_epi8(zero, shaded), _mm_unpacklo_epi8(weights, zero));
+                    hi = _mm_add_epi16(_mm_unpackhi_epi8(zero, shaded), _mm_unpackhi_epi8(weights, zero));
+                    _mm_storeu_si128((__m128i*)indexes, lo);
+                    _mm_storeu_si128((__m128i*)(indexes + 8), hi);
+
+                    for (int index = 0; index < SSE2_BLOCK_SIZE; index++) {
+                        block[index] = intensities[indexes[index]];
+                    }
+
+                    // Mix both, offsets into `colorMixAddTable` are
+                    // source * 256 + background.
+                    __m128i weighted = _mm_loadu_si128((__m128i*)block);
+                    __m128i weightedBackground = _mm_loadu_si128((__m128i*)backgroundBlock);
+                    lo = _mm_add_epi16(_mm_unpacklo_epi8(zero, weighted), _mm_unpacklo_epi8(weightedBackground, zero));
+                    hi = _mm_add_epi16(_mm_unpackhi_epi8(zero, weighted), _mm_unpackhi_epi8(weightedBackground, zero));
+                    _mm_storeu_si128((__m128i*)indexes, lo);
+                    _mm_storeu_si128((__m128i*)(indexes + 8), hi);
+
+                    for (int index = 0; index < SSE2_BLOCK_SIZE; index++) {
+                        block[index] = mixes[indexes[index]];
+                    }
+
+                    __m128i mixed = _mm_loadu_si128((__m128i*)block);
+                    shaded = _mm_or_si128(_mm_and_si128(unmasked, shaded), _mm_andnot_si128(unmasked, mixed));
+                }
+
+                if (transparentMask != 0) {
+                    shaded = _mm_or_si128(_mm_and_si128(transparent, background), _mm_andnot_si128(transparent, shaded));
+                }
+                _mm_storeu_si128((__m128i*)(dest + x), shaded);
+            }
+
+            for (; x < width; x++) {
+                unsigned char b = src[x];
+                if (b != 0) {
+                    b = shades[b];
+                    unsigned char m = mask[x];
+                    if (m != 0) {
+                        int q = intensityColorTable[dest[x]][128 - m];
+                        m = intensityColorTable[b][m];
+                        b = colorMixAddTable[m][q];
+                    }
+                    dest[x] = b;
+                }
+            }
+
+            src += srcPitch;
+            dest += destPitch;
+            mask += maskPitch;
+        }
+    } else {
+        int srcSkip = srcPitch - width;
+        int destSkip = destPitch - width;
+        int maskSkip = maskPitch - width;
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                unsigned char b = *src;
+                if (b != 0) {
+                    b = intensityColorTable[b][lightModifier];
+                    unsigned char m = *mask;
+                    if (m != 0) {
+                        unsigned char d = *dest;
+                        int q = intensityColorTable[d][128 - m];
+                        m = intensityColorTable[b][m];
+                        b = colorMixAddTable[m][q];
+                    }
+                    *dest = b;
+                }
+
+                src++;
+                dest++;
+                mask++;
+            }
+
+            src += srcSkip;
+            dest += destSkip;
+            mask += maskSkip;
+        }
+    }
+}
+
+// Fills `dest` with arithmetic progression starting at `value`.
+void mmxFillRamp(int* dest, int length, int value, int step)
+{
+    int index = 0;
+
+    if (sse2Enabled) {
+        __m128i values = _mm_setr_epi32(value, value + step, value + step * 2, value + step * 3);
+        __m128i steps = _mm_set1_epi32(step * 4);
+
+        for (; index + 4 <= length; index += 4) {
+            _mm_storeu_si128((__m128i*)(dest + index), values);
+            values = _mm_add_epi32(values, steps);
+        }
+
+        value += step * index;
+    }
+
+    for (; index < length; index++) {
+        dest[index] = value;
+        value += step;
+    }
+}
@@ -4,7 +4,12 @@
 #include <stdbool.h>
 
 bool mmxIsSupported();
+bool sse2IsSupported();
 void mmxBlit(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int width, int height);
 void mmxBlitTrans(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int width, int height);
+void mmxBlitDarkTrans(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int width, int height, int light);
+void mmxBlitIntensityTrans(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, int* intensities, int intensitiesPitch, int width, int height);
+void mmxBlitIntensityMask(unsigned char* dest, int destPitch, unsigned char* src, int srcPitch, unsigned char* mask, int maskPitch, int width, int height, int light);
+void mmxFillRamp(int* dest, int length, int value, int step);
 
 #endif /* MMX_H */
@@ -91,6 +91,10 @@ unsigned char colorTable[32768];
 // 0x6AB8D0
 static int tos;
 
+// Incremented every time color tables are rebuilt, see
+// [colorGetTablesGeneration].
+static unsigned int colorTablesGeneration = 0;
+
 // 0x6AB928
 static ColorReadFunc* readFunc;
 
@@ -509,6 +513,8 @@ bool loadColorTable(const char* path)
 
     rebuildColorBlendTables();
 
+    colorTablesGeneration++;
+
     // NOTE: Uninline.
     colorClose(fd);
 
@@ -752,9 +758,19 @@ bool colorPopColorPalette()
 
     rebuildColorBlendTables();
 
+    colorTablesGeneration++;
+
     return true;
 }
 
+// Returns a value which changes every time color tables (including
+// [intensityColorTable] and mix tables) are rebuilt. Used by clients which
+// cache data derived from these tables.
+unsigned int colorGetTablesGeneration()
+{
+    return colorTablesGeneration;
+}
+
 // 0x4C89CC
 bool initColors()
 {
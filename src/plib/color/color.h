@@ -61,6 +61,7 @@ double colorGetGamma();
 int colorMappedColor(ColorIndex i);
 bool colorPushColorPalette();
 bool colorPopColorPalette();
+unsigned int colorGetTablesGeneration();
 bool initColors();
 void colorsClose();
 unsigned char* getColorPalette();
@@ -648,11 +648,31 @@ void db_register_callback(FileReadProgressHandler* handler, int size)
 }
 
 // NOTE: This function is called when fallout2.cfg has "hashing" enabled, but
-// it does nothing. It's impossible to guess it's name.
+// in the original game it does nothing. It's impossible to guess it's name.
+//
+// Enables hash index of entries for .DAT files opened with subsequent calls
+// to [db_init].
 //
 // 0x4C68E4
 void db_enable_hash_table()
 {
+    dbase_enable_hashing(true);
+}
+
+// Enables mapping of .DAT files into memory instead of reading them via
+// separate stream for every open file.
+//
+// NOTE: Only affects .DAT files opened with subsequent calls to [db_init].
+void db_enable_mapping()
+{
+    dbase_enable_mapping(true);
+}
+
+// Enables seek indexes for large compressed entries, so that seeking in them
+// does not require decompressing data from the beginning.
+void db_enable_seek_index()
+{
+    dbase_enable_seek_index(true);
 }
 
 // 0x4C68E8
@@ -61,5 +61,7 @@ void db_register_mem(MallocProc* mallocProc, StrdupProc* strdupProc, FreeProc* f
 int db_filelength(File* stream);
 void db_register_callback(FileReadProgressHandler* handler, int size);
 void db_enable_hash_table();
+void db_enable_mapping();
+void db_enable_seek_index();
 
 #endif /* FALLOUT_PLIB_DB_DB_H_ */
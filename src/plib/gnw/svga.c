@@ -28,6 +28,10 @@ UpdatePaletteFunc* update_palette_func = NULL;
 // 0x51E2C8
 bool mmxEnabled = true;
 
+// Set by [mmxEnable] when CPU supports SSE2, selects SSE2 paths of kernels in
+// mmx.c.
+bool sse2Enabled = false;
+
 // 0x6AC7F0
 unsigned short GNW95_Pal16[256];
 
@@ -67,14 +71,21 @@ void mmxEnable(bool enable)
     // 0x6ACA20
     static bool mmx;
 
+    static bool sse2;
+
     if (!inited) {
         mmx = mmxIsSupported();
+        sse2 = sse2IsSupported();
         inited = true;
     }
 
     if (mmx) {
         mmxEnabled = enable;
     }
+
+    if (sse2) {
+        sse2Enabled = enable;
+    }
 }
 
 // 0x4CAD08
@@ -1,6 +1,7 @@
 #include "plib/xfile/dfile.h"
 
 #include <assert.h>
+#include <ctype.h>
 #include <io.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,16 +9,60 @@
 
 #include <fpattern.h>
 
-static_assert(sizeof(DBase) == 20, "wrong size");
+static_assert(sizeof(DBase) == 40, "wrong size");
 static_assert(sizeof(DBaseEntry) == 20, "wrong size");
-static_assert(sizeof(DFile) == 44, "wrong size");
+static_assert(sizeof(DFile) == 60, "wrong size");
 static_assert(sizeof(DFileFindData) == 524, "wrong size");
 
 static int dinfo_bsearch_compare(const void* a1, const void* a2);
 static DFile* dfile_fopen_helper(DBase* dbase, const char* filename, const char* mode, DFile* a4);
 static int dfile_fgetc_helper(DFile* stream);
 static bool dfile_read_comp_bytes(DFile* stream, void* ptr, size_t size);
+static bool dfile_inflate_bytes(DFile* stream, void* ptr, size_t size);
+static bool dfile_inflate_chunk(DFile* stream, void* ptr, size_t size);
+static bool dfile_skip_comp_bytes(DFile* stream, long size);
 static void dfile_zungetc(DFile* stream, int ch);
+static bool dbase_map(DBase* dbase);
+static unsigned char* dfile_mapped_data(DFile* stream);
+static bool dbase_build_hash_table(DBase* dbase);
+static unsigned int dbase_fold_path(const char* src, char* dest, size_t size);
+static DBaseEntry* dbase_find_entry(DBase* dbase, const char* filePath);
+static DFileSeekIndex* dbase_get_seek_index(DBase* dbase, DBaseEntry* entry);
+static void dfile_seek_index_free(DFileSeekIndex* seekIndex);
+static long dfile_seek_index_next_position(DFileSeekIndex* seekIndex);
+static void dfile_seek_index_capture(DFile* stream);
+static bool dfile_seek_index_restore(DFile* stream, long offset);
+
+// Specifies whether [dbase_open] should map .DAT files into memory.
+static bool dbase_mapping_enabled = false;
+
+// Specifies whether [dbase_open] should build hash index of entries.
+static bool dbase_hashing_enabled = false;
+
+// Specifies whether [dfile_fopen] should attach seek indexes to large
+// compressed entries.
+static bool dbase_seek_index_enabled = false;
+
+// Enables or disables mapping of .DAT files opened with [dbase_open] from now
+// on. Already opened [DBase]s are not affected.
+void dbase_enable_mapping(bool enabled)
+{
+    dbase_mapping_enabled = enabled;
+}
+
+// Enables or disables building hash index of entries for .DAT files opened
+// with [dbase_open] from now on. Already opened [DBase]s are not affected.
+void dbase_enable_hashing(bool enabled)
+{
+    dbase_hashing_enabled = enabled;
+}
+
+// Enables or disables seek indexes for large compressed entries of files
+// opened with [dfile_fopen] from now on.
+void dbase_enable_seek_index(bool enabled)
+{
+    dbase_seek_index_enabled = enabled;
+}
 
 // Reads .DAT file contents.
 //
@@ -126,6 +171,18 @@ DBase* dbase_open(const char* filePath)
 
     fclose(stream);
 
+    if (dbase_mapping_enabled) {
+        // Failure to map is not fatal, [DFile]s will use their own streams
+        // as usual.
+        dbase_map(dbase);
+    }
+
+    if (dbase_hashing_enabled) {
+        // Failure to build hash index is not fatal, entries will be looked
+        // up with binary search.
+        dbase_build_hash_table(dbase);
+    }
+
     return dbase;
 
 err:
@@ -167,6 +224,25 @@ bool dbase_close(DBase* dbase)
         free(dbase->path);
     }
 
+    if (dbase->data != NULL) {
+        UnmapViewOfFile(dbase->data);
+    }
+
+    if (dbase->hashSlots != NULL) {
+        free(dbase->hashSlots);
+    }
+
+    if (dbase->foldedPaths != NULL) {
+        free(dbase->foldedPaths);
+    }
+
+    DFileSeekIndex* seekIndex = dbase->seekIndexHead;
+    while (seekIndex != NULL) {
+        DFileSeekIndex* next = seekIndex->next;
+        dfile_seek_index_free(seekIndex);
+        seekIndex = next;
+    }
+
     memset(dbase, 0, sizeof(*dbase));
 
     free(dbase);
@@ -242,6 +318,10 @@ int dfile_fclose(DFile* stream)
         free(stream->decompressionBuffer);
     }
 
+    if (stream->inflatedBuffer != NULL) {
+        free(stream->inflatedBuffer);
+    }
+
     if (stream->stream != NULL) {
         fclose(stream->stream);
     }
@@ -439,6 +519,11 @@ size_t dfile_fread(void* ptr, size_t size, size_t count, DFile* stream)
         }
 
         bytesRead = bytesToRead;
+    } else if (stream->dbase->data != NULL) {
+        memcpy(ptr, dfile_mapped_data(stream) + stream->position, bytesToRead);
+
+        bytesRead = bytesToRead + extraBytesRead;
+        stream->position += bytesRead;
     } else {
         bytesRead = fread(ptr, 1, bytesToRead, stream->stream) + extraBytesRead;
         stream->position += bytesRead;
@@ -506,18 +591,29 @@ int dfile_fseek(DFile* stream, long offset, int origin)
 
     if (offsetFromBeginning != 0) {
         if (stream->entry->compressed == 1) {
-            if (offsetFromBeginning < pos) {
+            if (stream->seekIndex != NULL) {
+                // Jump to the nearest checkpoint preceding specified offset
+                // (if it's better than current position).
+                if (!dfile_seek_index_restore(stream, offsetFromBeginning)) {
+                    stream->flags |= DFILE_ERROR;
+                    return 1;
+                }
+            }
+
+            if (offsetFromBeginning < stream->position) {
                 // We cannot go backwards in compressed stream, so the only way
                 // is to start from the beginning.
                 dfile_rewind(stream);
             }
 
-            // Consume characters one by one until we reach specified offset.
-            while (offsetFromBeginning > stream->position) {
-                if (dfile_fgetc_helper(stream) == -1) {
-                    return 1;
-                }
+            // Decompress and discard data until we reach specified offset.
+            if (!dfile_skip_comp_bytes(stream, offsetFromBeginning - stream->position)) {
+                return 1;
             }
+        } else if (stream->dbase->data != NULL) {
+            // Mapped data is addressed by [position], there is no underlying
+            // stream to reposition.
+            stream->position = offsetFromBeginning;
         } else {
             if (fseek(stream->stream, offsetFromBeginning - pos, SEEK_CUR) != 0) {
                 stream->flags |= DFILE_ERROR;
@@ -533,6 +629,26 @@ int dfile_fseek(DFile* stream, long offset, int origin)
         return 0;
     }
 
+    if (stream->dbase->data != NULL) {
+        if (stream->entry->compressed == 1) {
+            if (inflateReset(stream->decompressionStream) != Z_OK) {
+                stream->flags |= DFILE_ERROR;
+                return 1;
+            }
+
+            stream->decompressionStream->next_in = dfile_mapped_data(stream);
+            stream->decompressionStream->avail_in = stream->entry->dataSize;
+        }
+
+        stream->position = 0;
+        stream->compressedBytesRead = stream->entry->dataSize;
+        stream->inflatedOffset = 0;
+        stream->inflatedLength = 0;
+        stream->flags &= ~(DFILE_HAS_UNGETC | DFILE_EOF);
+
+        return 0;
+    }
+
     if (fseek(stream->stream, stream->dbase->dataOffset + stream->entry->dataOffset, SEEK_SET) != 0) {
         stream->flags |= DFILE_ERROR;
         return 1;
@@ -556,6 +672,8 @@ int dfile_fseek(DFile* stream, long offset, int origin)
 
     stream->position = 0;
     stream->compressedBytesRead = 0;
+    stream->inflatedOffset = 0;
+    stream->inflatedLength = 0;
     stream->flags &= ~(DFILE_HAS_UNGETC | DFILE_EOF);
 
     return 0;
@@ -593,6 +711,17 @@ int dfile_feof(DFile* stream)
     return stream->flags & DFILE_EOF;
 }
 
+// Stops [stream] from using seek index of it's entry.
+//
+// Seek index is shared by all streams of the same entry and is not
+// synchronized, streams read on other threads must be detached from it.
+void dfile_detach_seek_index(DFile* stream)
+{
+    assert(stream);
+
+    stream->seekIndex = NULL;
+}
+
 // The [bsearch] comparison callback, which is used to find [DBaseEntry] for
 // specified [filePath].
 //
@@ -608,7 +737,7 @@ static int dinfo_bsearch_compare(const void* a1, const void* a2)
 // 0x4E5D9C
 static DFile* dfile_fopen_helper(DBase* dbase, const char* filePath, const char* mode, DFile* dfile)
 {
-    DBaseEntry* entry = (DBaseEntry*)bsearch(filePath, dbase->entries, dbase->entriesLength, sizeof(*dbase->entries), dinfo_bsearch_compare);
+    DBaseEntry* entry = dbase_find_entry(dbase, filePath);
     if (entry == NULL) {
         goto err;
     }
@@ -640,22 +769,61 @@ static DFile* dfile_fopen_helper(DBase* dbase, const char* filePath, const char*
         dfile->compressedBytesRead = 0;
         dfile->position = 0;
         dfile->flags = 0;
+        dfile->seekIndex = NULL;
+        dfile->inflatedOffset = 0;
+        dfile->inflatedLength = 0;
     }
 
     dfile->entry = entry;
 
-    // Open stream to .DAT file.
-    dfile->stream = fopen(dbase->path, "rb");
-    if (dfile->stream == NULL) {
-        goto err;
-    }
+    if (dbase->data == NULL) {
+        // Open stream to .DAT file.
+        dfile->stream = fopen(dbase->path, "rb");
+        if (dfile->stream == NULL) {
+            goto err;
+        }
 
-    // Relocate stream to the beginning of data for specified entry.
-    if (fseek(dfile->stream, dbase->dataOffset + entry->dataOffset, SEEK_SET) != 0) {
-        goto err;
+        // Relocate stream to the beginning of data for specified entry.
+        if (fseek(dfile->stream, dbase->dataOffset + entry->dataOffset, SEEK_SET) != 0) {
+            goto err;
+        }
     }
 
-    if (entry->compressed == 1) {
+    if (entry->compressed == 1 && dbase->data != NULL) {
+        // Entry is compressed, but the whole compressed data is already
+        // available in the mapped view, so there is no need for decompression
+        // buffer.
+        if (dfile->decompressionStream == NULL) {
+            dfile->decompressionStream = (z_streamp)malloc(sizeof(*dfile->decompressionStream));
+            if (dfile->decompressionStream == NULL) {
+                goto err;
+            }
+        }
+
+        if (dfile->decompressionBuffer != NULL) {
+            free(dfile->decompressionBuffer);
+            dfile->decompressionBuffer = NULL;
+        }
+
+        if (dfile->inflatedBuffer == NULL) {
+            dfile->inflatedBuffer = (unsigned char*)malloc(DFILE_INFLATED_BUFFER_SIZE);
+            if (dfile->inflatedBuffer == NULL) {
+                goto err;
+            }
+        }
+
+        dfile->decompressionStream->zalloc = Z_NULL;
+        dfile->decompressionStream->zfree = Z_NULL;
+        dfile->decompressionStream->opaque = Z_NULL;
+        dfile->decompressionStream->next_in = dfile_mapped_data(dfile);
+        dfile->decompressionStream->avail_in = entry->dataSize;
+
+        if (inflateInit(dfile->decompressionStream) != Z_OK) {
+            goto err;
+        }
+
+        dfile->compressedBytesRead = entry->dataSize;
+    } else if (entry->compressed == 1) {
         // Entry is compressed, setup decompression stream and decompression
         // buffer. This step is not needed when previous instance of dfile is
         // passed via parameter, which might already have stream and
@@ -672,6 +840,13 @@ static DFile* dfile_fopen_helper(DBase* dbase, const char* filePath, const char*
             }
         }
 
+        if (dfile->inflatedBuffer == NULL) {
+            dfile->inflatedBuffer = (unsigned char*)malloc(DFILE_INFLATED_BUFFER_SIZE);
+            if (dfile->inflatedBuffer == NULL) {
+                goto err;
+            }
+        }
+
         dfile->decompressionStream->zalloc = Z_NULL;
         dfile->decompressionStream->zfree = Z_NULL;
         dfile->decompressionStream->opaque = Z_NULL;
@@ -694,6 +869,17 @@ static DFile* dfile_fopen_helper(DBase* dbase, const char* filePath, const char*
             free(dfile->decompressionBuffer);
             dfile->decompressionBuffer = NULL;
         }
+
+        if (dfile->inflatedBuffer != NULL) {
+            free(dfile->inflatedBuffer);
+            dfile->inflatedBuffer = NULL;
+        }
+    }
+
+    if (entry->compressed == 1 && entry->uncompressedSize >= DFILE_SEEK_INDEX_MIN_SIZE && dbase_seek_index_enabled) {
+        // Failure to obtain seek index is not fatal, seeking will decompress
+        // data from the beginning.
+        dfile->seekIndex = dbase_get_seek_index(dbase, entry);
     }
 
     if (mode[1] == 't') {
@@ -744,6 +930,26 @@ static int dfile_fgetc_helper(DFile* stream)
         return -1;
     }
 
+    if (stream->dbase->data != NULL) {
+        unsigned char* data = dfile_mapped_data(stream);
+        int ch = data[stream->position];
+        if ((stream->flags & DFILE_TEXT) != 0) {
+            // This is a text stream, attempt to detect \r\n sequence.
+            if (ch == '\r') {
+                if (stream->position + 1 < stream->entry->uncompressedSize) {
+                    if (data[stream->position + 1] == '\n') {
+                        ch = '\n';
+                        stream->position++;
+                    }
+                }
+            }
+        }
+
+        stream->position++;
+
+        return ch;
+    }
+
     int ch = fgetc(stream->stream);
     if (ch != -1) {
         if ((stream->flags & DFILE_TEXT) != 0) {
@@ -785,6 +991,135 @@ static bool dfile_read_comp_bytes(DFile* stream, void* ptr, size_t size)
         }
     }
 
+    unsigned char* byteBuffer = (unsigned char*)ptr;
+
+    // Consume data decompressed by previous reads.
+    size_t bytesToCopy = stream->inflatedLength - stream->inflatedOffset;
+    if (bytesToCopy != 0) {
+        if (bytesToCopy > size) {
+            bytesToCopy = size;
+        }
+
+        memcpy(byteBuffer, stream->inflatedBuffer + stream->inflatedOffset, bytesToCopy);
+        stream->inflatedOffset += bytesToCopy;
+        stream->position += bytesToCopy;
+
+        byteBuffer += bytesToCopy;
+        size -= bytesToCopy;
+
+        if (size == 0) {
+            return true;
+        }
+    }
+
+    // At this point [inflatedBuffer] is exhausted. Small reads refill it with
+    // the next block of decompressed data, so that subsequent reads are
+    // served without calling [inflate].
+    if (size < DFILE_INFLATED_BUFFER_SIZE) {
+        size_t blockSize = stream->entry->uncompressedSize - stream->decompressionStream->total_out;
+        if (blockSize > DFILE_INFLATED_BUFFER_SIZE) {
+            blockSize = DFILE_INFLATED_BUFFER_SIZE;
+        }
+
+        if (blockSize >= size) {
+            if (!dfile_inflate_bytes(stream, stream->inflatedBuffer, blockSize)) {
+                stream->inflatedOffset = 0;
+                stream->inflatedLength = 0;
+                return false;
+            }
+
+            memcpy(byteBuffer, stream->inflatedBuffer, size);
+            stream->inflatedOffset = size;
+            stream->inflatedLength = blockSize;
+            stream->position += size;
+
+            return true;
+        }
+    }
+
+    if (!dfile_inflate_bytes(stream, byteBuffer, size)) {
+        return false;
+    }
+
+    stream->position += size;
+
+    return true;
+}
+
+// Decompresses exactly [size] bytes into [ptr] capturing seek index
+// checkpoints along the way.
+static bool dfile_inflate_bytes(DFile* stream, void* ptr, size_t size)
+{
+    unsigned char* compressedData = NULL;
+
+    if (stream->dbase->data == NULL
+        && size > DFILE_INFLATED_BUFFER_SIZE
+        && stream->decompressionStream->total_out + size == (uLong)stream->entry->uncompressedSize) {
+        // We're asked to decompress everything up to the end of entry (which
+        // is typical for [db_read_to_buf]). Read remaining compressed data at
+        // once and let [inflate] process it in one go instead of feeding it
+        // in [DFILE_DECOMPRESSION_BUFFER_SIZE] chunks.
+        size_t pendingSize = stream->decompressionStream->avail_in;
+        size_t remainingSize = stream->entry->dataSize - stream->compressedBytesRead;
+        if (remainingSize != 0) {
+            compressedData = (unsigned char*)malloc(pendingSize + remainingSize);
+            if (compressedData != NULL) {
+                memcpy(compressedData, stream->decompressionStream->next_in, pendingSize);
+
+                if (fread(compressedData + pendingSize, remainingSize, 1, stream->stream) != 1) {
+                    free(compressedData);
+                    return false;
+                }
+
+                stream->decompressionStream->next_in = compressedData;
+                stream->decompressionStream->avail_in = pendingSize + remainingSize;
+                stream->compressedBytesRead += remainingSize;
+            }
+        }
+    }
+
+    bool success = true;
+    unsigned char* byteBuffer = (unsigned char*)ptr;
+
+    while (size != 0) {
+        size_t chunkSize = size;
+
+        if (stream->seekIndex != NULL) {
+            // Decompress data in pieces so that every seek index checkpoint
+            // is captured as close as possible to its designated position.
+            long distance = dfile_seek_index_next_position(stream->seekIndex) - (long)stream->decompressionStream->total_out;
+            if (distance > 0 && (size_t)distance < chunkSize) {
+                chunkSize = distance;
+            }
+        }
+
+        if (!dfile_inflate_chunk(stream, byteBuffer, chunkSize)) {
+            success = false;
+            break;
+        }
+
+        if (stream->seekIndex != NULL) {
+            dfile_seek_index_capture(stream);
+        }
+
+        byteBuffer += chunkSize;
+        size -= chunkSize;
+    }
+
+    if (compressedData != NULL) {
+        // Leftovers (if any) are zlib trailer, there is no need to keep them.
+        stream->decompressionStream->next_in = stream->decompressionBuffer;
+        stream->decompressionStream->avail_in = 0;
+        free(compressedData);
+    }
+
+    return success;
+}
+
+// Decompresses exactly [size] bytes into [ptr] reading compressed data as
+// needed.
+static bool dfile_inflate_chunk(DFile* stream, void* ptr, size_t size)
+{
     stream->decompressionStream->next_out = (Bytef*)ptr;
     stream->decompressionStream->avail_out = size;
 
@@ -795,6 +1130,12 @@ static bool dfile_read_comp_bytes(DFile* stream, void* ptr, size_t size)
         }
 
         if (stream->decompressionStream->avail_in == 0) {
+            if (stream->dbase->data != NULL) {
+                // Entire compressed data was fed from the mapped view at
+                // once, there are no more chunks to read.
+                break;
+            }
+
             // No more unprocessed data, request next chunk.
             size_t bytesToRead = stream->entry->dataSize - stream->compressedBytesRead;
             if (bytesToRead > DFILE_DECOMPRESSION_BUFFER_SIZE) {
@@ -818,8 +1159,6 @@ static bool dfile_read_comp_bytes(DFile* stream, void* ptr, size_t size)
         return false;
     }
 
-    stream->position += size;
-
     return true;
 }
 
@@ -832,3 +1171,320 @@ static void dfile_zungetc(DFile* stream, int ch)
     stream->flags |= DFILE_HAS_COMPRESSED_UNGETC;
     stream->position--;
 }
+
+// Maps entire .DAT file represented by [dbase] into memory.
+//
+// Returns `true` on success. On failure [dbase] is left unmapped.
+static bool dbase_map(DBase* dbase)
+{
+    HANDLE file = CreateFileA(dbase->path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    // The mapping object keeps reference to the file, and the view keeps
+    // reference to the mapping object, so both handles can be closed right
+    // away.
+    CloseHandle(file);
+
+    if (mapping == NULL) {
+        return false;
+    }
+
+    dbase->data = (unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    CloseHandle(mapping);
+
+    return dbase->data != NULL;
+}
+
+// Returns pointer to the beginning of data for [stream]'s entry in mapped
+// view.
+static unsigned char* dfile_mapped_data(DFile* stream)
+{
+    return stream->dbase->data + stream->dbase->dataOffset + stream->entry->dataOffset;
+}
+
+// Builds hash index of [dbase] entries.
+//
+// Returns `true` on success. On failure [dbase] is left without hash index.
+static bool dbase_build_hash_table(DBase* dbase)
+{
+    int foldedPathsSize = 0;
+    for (int index = 0; index < dbase->entriesLength; index++) {
+        foldedPathsSize += strlen(dbase->entries[index].path) + 1;
+    }
+
+    // Keep load factor at or below 50% so that probe sequences stay short.
+    int hashSlotsLength = 16;
+    while (hashSlotsLength < dbase->entriesLength * 2) {
+        hashSlotsLength *= 2;
+    }
+
+    dbase->foldedPaths = (char*)malloc(foldedPathsSize);
+    dbase->hashSlots = (DBaseHashSlot*)malloc(sizeof(*dbase->hashSlots) * hashSlotsLength);
+    if (dbase->foldedPaths == NULL || dbase->hashSlots == NULL) {
+        goto err;
+    }
+
+    dbase->hashSlotsLength = hashSlotsLength;
+
+    for (int index = 0; index < hashSlotsLength; index++) {
+        dbase->hashSlots[index].entryIndex = -1;
+    }
+
+    int foldedPathOffset = 0;
+    for (int entryIndex = 0; entryIndex < dbase->entriesLength; entryIndex++) {
+        char* foldedPath = dbase->foldedPaths + foldedPathOffset;
+        int foldedPathSize = strlen(dbase->entries[entryIndex].path) + 1;
+        unsigned int hash = dbase_fold_path(dbase->entries[entryIndex].path, foldedPath, foldedPathSize);
+
+        int slotIndex = hash & (hashSlotsLength - 1);
+        while (dbase->hashSlots[slotIndex].entryIndex != -1) {
+            DBaseHashSlot* slot = &(dbase->hashSlots[slotIndex]);
+            if (slot->hash == hash && strcmp(dbase->foldedPaths + slot->foldedPathOffset, foldedPath) == 0) {
+                // Duplicate path, keep the first entry.
+                break;
+            }
+
+            slotIndex = (slotIndex + 1) & (hashSlotsLength - 1);
+        }
+
+        DBaseHashSlot* slot = &(dbase->hashSlots[slotIndex]);
+        if (slot->entryIndex == -1) {
+            slot->hash = hash;
+            slot->entryIndex = entryIndex;
+            slot->foldedPathOffset = foldedPathOffset;
+        }
+
+        foldedPathOffset += foldedPathSize;
+    }
+
+    return true;
+
+err:
+
+    if (dbase->foldedPaths != NULL) {
+        free(dbase->foldedPaths);
+        dbase->foldedPaths = NULL;
+    }
+
+    if (dbase->hashSlots != NULL) {
+        free(dbase->hashSlots);
+        dbase->hashSlots = NULL;
+    }
+
+    dbase->hashSlotsLength = 0;
+
+    return false;
+}
+
+// Copies [src] into [dest] converting it to lowercase (the same way [stricmp]
+// compares strings), and returns FNV-1a hash of the result.
+//
+// The [dest] is always null-terminated, [src] is truncated if it does not fit
+// into [size] bytes.
+static unsigned int dbase_fold_path(const char* src, char* dest, size_t size)
+{
+    unsigned int hash = 2166136261U;
+
+    char* end = dest + size - 1;
+    while (*src != '\0' && dest < end) {
+        unsigned char ch = (unsigned char)tolower((unsigned char)*src++);
+        *dest++ = ch;
+
+        hash ^= ch;
+        hash *= 16777619U;
+    }
+
+    *dest = '\0';
+
+    return hash;
+}
+
+// Finds [DBaseEntry] for specified [filePath].
+//
+// Uses hash index when available, otherwise falls back to binary search.
+static DBaseEntry* dbase_find_entry(DBase* dbase, const char* filePath)
+{
+    if (dbase->hashSlots == NULL || strlen(filePath) >= MAX_PATH) {
+        return (DBaseEntry*)bsearch(filePath, dbase->entries, dbase->entriesLength, sizeof(*dbase->entries), dinfo_bsearch_compare);
+    }
+
+    char foldedPath[MAX_PATH];
+    unsigned int hash = dbase_fold_path(filePath, foldedPath, sizeof(foldedPath));
+
+    int slotIndex = hash & (dbase->hashSlotsLength - 1);
+    while (dbase->hashSlots[slotIndex].entryIndex != -1) {
+        DBaseHashSlot* slot = &(dbase->hashSlots[slotIndex]);
+        if (slot->hash == hash && strcmp(dbase->foldedPaths + slot->foldedPathOffset, foldedPath) == 0) {
+            return &(dbase->entries[slot->entryIndex]);
+        }
+
+        slotIndex = (slotIndex + 1) & (dbase->hashSlotsLength - 1);
+    }
+
+    return NULL;
+}
+
+// Decompresses and discards [size] bytes of compressed stream.
+static bool dfile_skip_comp_bytes(DFile* stream, long size)
+{
+    unsigned char buffer[DFILE_DECOMPRESSION_BUFFER_SIZE];
+
+    while (size > 0) {
+        size_t chunkSize = size;
+        if (chunkSize > sizeof(buffer)) {
+            chunkSize = sizeof(buffer);
+        }
+
+        if (!dfile_read_comp_bytes(stream, buffer, chunkSize)) {
+            return false;
+        }
+
+        size -= chunkSize;
+    }
+
+    return true;
+}
+
+// Returns seek index for [entry], creating empty one if needed.
+//
+// Returns NULL if seek index cannot be created.
+static DFileSeekIndex* dbase_get_seek_index(DBase* dbase, DBaseEntry* entry)
+{
+    DFileSeekIndex* seekIndex = dbase->seekIndexHead;
+    while (seekIndex != NULL) {
+        if (seekIndex->entry == entry) {
+            return seekIndex;
+        }
+        seekIndex = seekIndex->next;
+    }
+
+    seekIndex = (DFileSeekIndex*)malloc(sizeof(*seekIndex));
+    if (seekIndex == NULL) {
+        return NULL;
+    }
+
+    memset(seekIndex, 0, sizeof(*seekIndex));
+
+    // Checkpoints are at least [DFILE_SEEK_INDEX_INTERVAL] bytes apart and
+    // there is none at the very beginning.
+    seekIndex->checkpointsCapacity = entry->uncompressedSize / DFILE_SEEK_INDEX_INTERVAL;
+    seekIndex->checkpoints = (DFileSeekCheckpoint*)malloc(sizeof(*seekIndex->checkpoints) * seekIndex->checkpointsCapacity);
+    if (seekIndex->checkpoints == NULL) {
+        free(seekIndex);
+        return NULL;
+    }
+
+    seekIndex->entry = entry;
+    seekIndex->next = dbase->seekIndexHead;
+    dbase->seekIndexHead = seekIndex;
+
+    return seekIndex;
+}
+
+// Frees [seekIndex] and all of it's checkpoints.
+static void dfile_seek_index_free(DFileSeekIndex* seekIndex)
+{
+    for (int index = 0; index < seekIndex->checkpointsLength; index++) {
+        inflateEnd(&(seekIndex->checkpoints[index].stream));
+    }
+
+    free(seekIndex->checkpoints);
+    free(seekIndex);
+}
+
+// Returns position at which next checkpoint should be captured.
+static long dfile_seek_index_next_position(DFileSeekIndex* seekIndex)
+{
+    if (seekIndex->checkpointsLength == 0) {
+        return DFILE_SEEK_INDEX_INTERVAL;
+    }
+
+    return seekIndex->checkpoints[seekIndex->checkpointsLength - 1].position + DFILE_SEEK_INDEX_INTERVAL;
+}
+
+// Captures decompression state of [stream] into it's seek index if it has
+// reached position of the next checkpoint.
+static void dfile_seek_index_capture(DFile* stream)
+{
+    DFileSeekIndex* seekIndex = stream->seekIndex;
+
+    if (seekIndex->checkpointsLength >= seekIndex->checkpointsCapacity) {
+        return;
+    }
+
+    // Decompression stream can be ahead of [position] (because of buffered
+    // or ungot data), so checkpoints are positioned by the amount of data
+    // produced by decompression stream.
+    long position = stream->decompressionStream->total_out;
+    if (position < dfile_seek_index_next_position(seekIndex)) {
+        return;
+    }
+
+    DFileSeekCheckpoint* checkpoint = &(seekIndex->checkpoints[seekIndex->checkpointsLength]);
+    if (inflateCopy(&(checkpoint->stream), stream->decompressionStream) != Z_OK) {
+        return;
+    }
+
+    checkpoint->position = position;
+    seekIndex->checkpointsLength++;
+}
+
+// Restores decompression state of [stream] from the last checkpoint at or
+// before [offset], unless current position is already closer.
+//
+// Returns `false` if decompression stream is no longer usable.
+static bool dfile_seek_index_restore(DFile* stream, long offset)
+{
+    DFileSeekIndex* seekIndex = stream->seekIndex;
+
+    DFileSeekCheckpoint* checkpoint = NULL;
+    for (int index = 0; index < seekIndex->checkpointsLength; index++) {
+        if (seekIndex->checkpoints[index].position > offset) {
+            break;
+        }
+        checkpoint = &(seekIndex->checkpoints[index]);
+    }
+
+    if (checkpoint == NULL) {
+        return true;
+    }
+
+    if (checkpoint->position <= stream->position && stream->position <= offset) {
+        return true;
+    }
+
+    if (inflateEnd(stream->decompressionStream) != Z_OK) {
+        return false;
+    }
+
+    if (inflateCopy(stream->decompressionStream, &(checkpoint->stream)) != Z_OK) {
+        return false;
+    }
+
+    uLong compressedBytesConsumed = checkpoint->stream.total_in;
+
+    if (stream->dbase->data != NULL) {
+        stream->decompressionStream->next_in = dfile_mapped_data(stream) + compressedBytesConsumed;
+        stream->decompressionStream->avail_in = stream->entry->dataSize - compressedBytesConsumed;
+    } else {
+        if (fseek(stream->stream, stream->dbase->dataOffset + stream->entry->dataOffset + compressedBytesConsumed, SEEK_SET) != 0) {
+            return false;
+        }
+
+        stream->decompressionStream->next_in = stream->decompressionBuffer;
+        stream->decompressionStream->avail_in = 0;
+        stream->compressedBytesRead = compressedBytesConsumed;
+    }
+
+    stream->position = checkpoint->position;
+    stream->inflatedOffset = 0;
+    stream->inflatedLength = 0;
+    stream->flags &= ~DFILE_HAS_COMPRESSED_UNGETC;
+
+    return true;
+}
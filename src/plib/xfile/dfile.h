@@ -12,6 +12,17 @@
 // The size of decompression buffer for reading compressed [DFile]s.
 #define DFILE_DECOMPRESSION_BUFFER_SIZE (0x400)
 
+// The size of buffer holding decompressed data for small reads from compressed
+// [DFile]s.
+#define DFILE_INFLATED_BUFFER_SIZE (0x1000)
+
+// The minimum uncompressed size of compressed entry to build seek index for.
+#define DFILE_SEEK_INDEX_MIN_SIZE (0x80000)
+
+// The minimum distance (in terms of uncompressed data) between seek index
+// checkpoints.
+#define DFILE_SEEK_INDEX_INTERVAL (0x40000)
+
 // Specifies that [DFile] has unget character.
 //
 // NOTE: There is an unused function at 0x4E5894 which ungets one character and
@@ -35,6 +46,8 @@
 
 typedef struct DBase DBase;
 typedef struct DBaseEntry DBaseEntry;
+typedef struct DBaseHashSlot DBaseHashSlot;
+typedef struct DFileSeekIndex DFileSeekIndex;
 typedef struct DFile DFile;
 
 // A representation of .DAT file.
@@ -53,6 +66,34 @@ typedef struct DBase {
 
     // The head of linked list of open file handles.
     DFile* dfileHead;
+
+    // The read-only view of entire .DAT file.
+    //
+    // This value is NULL unless mapping was enabled with
+    // [dbase_enable_mapping] before opening .DAT file. When set, [DFile]s do
+    // not open their own streams, instead uncompressed entries are read
+    // directly from this view, and compressed entries are inflated from it.
+    unsigned char* data;
+
+    // The open-addressing hash index of [entries] keyed by case-folded path.
+    //
+    // This value is NULL unless hashing was enabled with
+    // [dbase_enable_hashing] before opening .DAT file, in this case entries
+    // are looked up with binary search.
+    DBaseHashSlot* hashSlots;
+
+    // The number of slots in [hashSlots], always a power of two.
+    int hashSlotsLength;
+
+    // The case-folded paths of [entries] stored back to back, referenced by
+    // [DBaseHashSlot.foldedPathOffset].
+    char* foldedPaths;
+
+    // The head of linked list of seek indexes built for compressed entries.
+    //
+    // Seek indexes outlive [DFile]s they were built with, so that subsequent
+    // handles to the same entry can seek quickly right away.
+    DFileSeekIndex* seekIndexHead;
 } DBase;
 
 typedef struct DBaseEntry {
@@ -63,6 +104,51 @@ typedef struct DBaseEntry {
     int dataOffset;
 } DBaseEntry;
 
+typedef struct DBaseHashSlot {
+    // The hash of case-folded path.
+    unsigned int hash;
+
+    // The index of [DBaseEntry] in [DBase.entries], or -1 if this slot is
+    // empty.
+    int entryIndex;
+
+    // The offset of case-folded path in [DBase.foldedPaths].
+    int foldedPathOffset;
+} DBaseHashSlot;
+
+// A snapshot of decompression state of compressed entry.
+typedef struct DFileSeekCheckpoint {
+    // The position in uncompressed data this checkpoint was captured at.
+    long position;
+
+    // The copy of inflate stream at [position].
+    //
+    // The amount of compressed data consumed to reach this state is available
+    // in [total_in].
+    z_stream stream;
+} DFileSeekCheckpoint;
+
+// A list of decompression checkpoints of compressed entry, which allows to
+// seek in compressed data without decompressing it from the beginning.
+//
+// Checkpoints are captured as entry is being decompressed for the first time
+// and are at least [DFILE_SEEK_INDEX_INTERVAL] bytes apart.
+typedef struct DFileSeekIndex {
+    DBaseEntry* entry;
+
+    // The array of checkpoints sorted by position.
+    DFileSeekCheckpoint* checkpoints;
+
+    // The number of captured checkpoints.
+    int checkpointsLength;
+
+    // The maximum number of checkpoints [checkpoints] can hold.
+    int checkpointsCapacity;
+
+    // Next [DFileSeekIndex] in linked list.
+    struct DFileSeekIndex* next;
+} DFileSeekIndex;
+
 // A handle to open entry in .DAT file.
 typedef struct DFile {
     DBase* dbase;
@@ -74,6 +160,8 @@ typedef struct DFile {
     // This stream is not shared across open handles. Instead every [DFile]
     // opens it's own stream via [fopen], which is then closed via [fclose] in
     // [dfile_fclose].
+    //
+    // This value is NULL if [dbase] is mapped into memory.
     FILE* stream;
 
     // The inflate stream used to decompress data.
@@ -83,9 +171,27 @@ typedef struct DFile {
 
     // The decompression buffer of size [DFILE_DECOMPRESSION_BUFFER_SIZE].
     //
-    // This value is NULL if entry is not compressed.
+    // This value is NULL if entry is not compressed, or if [dbase] is mapped
+    // into memory (in this case compressed data is consumed directly from the
+    // mapped view).
     unsigned char* decompressionBuffer;
 
+    // The buffer of size [DFILE_INFLATED_BUFFER_SIZE] holding decompressed
+    // data which is not yet consumed.
+    //
+    // Small reads (like [dfile_fgetc] and [dfile_fgets]) are served from this
+    // buffer, which is refilled with one [inflate] call when exhausted. Large
+    // reads bypass it and decompress directly into destination.
+    //
+    // This value is NULL if entry is not compressed.
+    unsigned char* inflatedBuffer;
+
+    // The offset of the first unconsumed byte in [inflatedBuffer].
+    int inflatedOffset;
+
+    // The number of decompressed bytes in [inflatedBuffer].
+    int inflatedLength;
+
     // The last ungot character.
     //
     // See [DFILE_HAS_UNGETC] notes.
@@ -109,6 +215,12 @@ typedef struct DFile {
     // streams). The range is 0..entry->uncompressedSize.
     long position;
 
+    // The seek index of compressed entry.
+    //
+    // This value is NULL if seek indexes are not enabled, or entry is not
+    // compressed, or it's too small to benefit from seek index.
+    DFileSeekIndex* seekIndex;
+
     // Next [DFile] in linked list.
     //
     // [DFile]s are stored in [DBase] in reverse order, so it's actually a
@@ -134,6 +246,9 @@ typedef struct DFileFindData {
     int index;
 } DFileFindData;
 
+void dbase_enable_mapping(bool enabled);
+void dbase_enable_hashing(bool enabled);
+void dbase_enable_seek_index(bool enabled);
 DBase* dbase_open(const char* filename);
 bool dbase_close(DBase* dbase);
 bool dbase_findfirst(DBase* dbase, DFileFindData* findFileData, const char* pattern);
@@ -153,5 +268,6 @@ int dfile_fseek(DFile* stream, long offset, int origin);
 long dfile_ftell(DFile* stream);
 void dfile_rewind(DFile* stream);
 int dfile_feof(DFile* stream);
+void dfile_detach_seek_index(DFile* stream);
 
 #endif /* FALLOUT_PLIB_XFILE_DFILE_H_ */
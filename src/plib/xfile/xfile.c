@@ -426,6 +426,16 @@ long xfilelength(XFile* stream)
     return fileSize;
 }
 
+// Stops [stream] from using shared seek index, see [dfile_detach_seek_index].
+void xfdetach_seek_index(XFile* stream)
+{
+    assert(stream);
+
+    if (stream->type == XFILE_TYPE_DFILE) {
+        dfile_detach_seek_index(stream->dfile);
+    }
+}
+
 // Closes all open xbases and opens a set of xbases specified by [paths].
 //
 // [paths] is a set of paths separated by semicolon. Can be NULL, in this case
@@ -75,6 +75,7 @@ long xftell(XFile* stream);
 void xrewind(XFile* stream);
 int xfeof(XFile* stream);
 long xfilelength(XFile* stream);
+void xfdetach_seek_index(XFile* stream);
 bool xsetpath(char* paths);
 bool xaddpath(const char* path);
 bool xenumpath(const char* pattern, XListEnumerationHandler* handler, XList* xlist);